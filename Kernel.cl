@@ -0,0 +1,9 @@
+__kernel void MyKernel(__global const float * In, __global float * Out, float Factor) {
+    size_t i = get_global_id(0);
+    Out[i] = Factor * In[i];
+}
+
+__kernel void AddKernel(__global const float * A, __global const float * B, __global float * Out) {
+    size_t i = get_global_id(0);
+    Out[i] = A[i] + B[i];
+}
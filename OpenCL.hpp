@@ -8,9 +8,20 @@
 ///
 
 #include <CL/cl.hpp>
+#include "OpenCLCache.hpp"
+#include "OpenCLDeviceProfile.hpp"
+#include "OpenCLNuma.hpp"
+#include "OpenCLPlacement.hpp"
+#include "OpenCLProfiling.hpp"
+#include "OpenCLRegistry.hpp"
+#include "OpenCLRuntime.hpp"
 #include <cassert>
+#include <climits>
+#include <cstdio>
 #include <fstream>
 #include <algorithm>
+#include <memory>
+#include <sstream>
 
 ///
 /// \namespace OpenCLWrapper
@@ -24,16 +35,128 @@ namespace OpenCLWrapper {
 /// \details Those parameters can be set using SetParameter()
 ///
 enum OpenCLParameters {
-    TargetDevice,  ///< Select the prefered target device (CPU, GPU, ...)
-    BuildOptions,  ///< Define parameters used during OpenCL kernel build
-    MaxParameters  ///< Parameter index cannot be higher
+    TargetDevice,       ///< Select the prefered target device (CPU, GPU, ...)
+    BuildOptions,       ///< Define parameters used during OpenCL kernel build
+    RecordedCommands,   ///< Define how many commands are kept for profiling
+    ProfilingMode,      ///< Select which commands are profiled (see ProfilingModes)
+    ProfilingSampling,  ///< Define N so that 1 command in N is profiled when sampling
+    ProgramCaching,     ///< Enable (1) or disable (0) the cache of built programs
+    DeviceProfiles,     ///< Define the file with the measured device profiles
+    DeviceSelection,    ///< Select how the device is selected (see DeviceSelections)
+    RequiredExtensions, ///< Define the extensions the selected device must support
+    DevicePlacement,    ///< Enable (1) or disable (0) placing kernels on the fastest device
+    PlacementProbes,    ///< Define how many times kernels are probed on each device
+    PlacementInterval,  ///< Define N so that 1 invocation in N probes another device
+    DevicePartition,    ///< Select how the device is partitioned (see PartitionModes)
+    PartitionCounts,    ///< Define the compute units of each sub-device, separated by spaces
+    SubDevice,          ///< Select the sub-device that is used, once partitioned
+    NumaPolicy,         ///< Select where host buffers are placed (see NumaPolicies)
+    NumaNode,           ///< Define the NUMA node of host buffers with NumaExplicit
+    ConcurrentQueues,   ///< Define how many queues EnqueueKernel() uses without out of order queues
+    MaxParameters       ///< Parameter index cannot be higher
 };
 
 ///
-/// \class OpenCL
-/// \brief Main wrapper class
+/// \enum    ProfilingModes
+/// \brief   Enumeration for all the supported profiling modes
+/// \details Those modes can be set using SetParameter() with ProfilingMode
 ///
-class OpenCL {
+enum ProfilingModes {
+    ProfilingOff,     ///< No command is profiled
+    ProfilingAlways,  ///< All the commands are profiled
+    ProfilingSampled, ///< 1 command in N is profiled, see ProfilingSampling
+    MaxProfilingModes ///< Profiling mode cannot be higher
+};
+
+///
+/// \enum    DeviceSelections
+/// \brief   Enumeration for all the supported device selections
+/// \details Those selections can be set using SetParameter() with DeviceSelection
+///
+enum DeviceSelections {
+    SelectionByOrder,   ///< First device found: accelerators, then GPUs, then CPUs
+    SelectionByScore,   ///< Device with the highest score, see SetDeviceScorer()
+    MaxDeviceSelections ///< Device selection cannot be higher
+};
+
+///
+/// \enum    PartitionModes
+/// \brief   Enumeration for all the supported device partitions
+/// \details Those partitions can be set using SetParameter() with DevicePartition
+///
+enum PartitionModes {
+    PartitionOff,      ///< The device isn't partitioned
+    PartitionByNuma,   ///< One sub-device per NUMA node
+    PartitionByCounts, ///< One sub-device per count of compute units, see PartitionCounts
+    MaxPartitionModes  ///< Partition mode cannot be higher
+};
+
+///
+/// \enum    OccupancyFlags
+/// \brief   Enumeration for all the issues a launch geometry can have
+/// \details Those flags are reported by GetKernelOccupancy()
+///
+enum OccupancyFlags {
+    GroupTooLarge    = 0x1,  ///< The work-group is larger than what the kernel supports
+    FewGroups        = 0x2,  ///< There are less work-groups than compute units
+    SmallGroups      = 0x4,  ///< The work-group is smaller than the preferred multiple
+    PartialGroups    = 0x8,  ///< The work-group isn't a multiple of the preferred multiple
+    LocalMemoryBound = 0x10, ///< Only one work-group fits in local memory per compute unit
+    MismatchedRanges = 0x20  ///< The local range doesn't have as many dimensions as the global one
+};
+
+///
+/// \struct  KernelResources
+/// \brief   Resources used by a kernel on a device
+///
+struct KernelResources {
+    /// Maximum work-group size the kernel can be launched with
+    size_t   WorkGroupSize;
+    /// Local memory used by a work-group, in bytes
+    cl_ulong LocalMemSize;
+    /// Private memory used by a work-item, in bytes
+    cl_ulong PrivateMemSize;
+    /// Preferred multiple of the work-group size
+    size_t   PreferredMultiple;
+};
+
+///
+/// \struct  OccupancyReport
+/// \brief   Estimation of how well a launch uses the device
+///
+struct OccupancyReport {
+    /// Resources used by the kernel
+    KernelResources Resources;
+    /// Number of work-items
+    size_t          GlobalSize;
+    /// Number of work-items per work-group
+    size_t          LocalSize;
+    /// Number of work-groups
+    size_t          Groups;
+    /// Number of compute units of the device
+    cl_uint         ComputeUnits;
+    /// Local memory available per compute unit, in bytes
+    cl_ulong        DeviceLocalMemSize;
+    /// Ratio of the lanes doing work in each work-group
+    double          LaneEfficiency;
+    /// Ratio of the compute units that get at least one work-group
+    double          UnitCoverage;
+    /// Estimated occupancy: LaneEfficiency * UnitCoverage
+    double          Occupancy;
+    /// Issues found with the launch geometry, see OccupancyFlags
+    unsigned int    Flags;
+};
+
+///
+/// \class   BasicOpenCL
+/// \tparam  Instrumentation Instrumentation policy (NoInstrumentation, FullTracing)
+/// \brief   Main wrapper class
+/// \details The instrumentation policy selects at compile time whether
+///          commands are timed, recorded and accounted. With
+///          NoInstrumentation, all of it is compiled out.
+///
+template<typename Instrumentation>
+class BasicOpenCL {
 private:
     /// Event used to measure performances on any operation done by OpenCL
     cl::Event                 mEvent;
@@ -49,14 +172,88 @@ private:
     cl_device_type            mTargetDevice;
     /// List of devices that are in the current context
     std::vector<cl::Device> * mDevices;
-
-    ///
-    /// \fn      OpenCL
+    /// Recorder keeping the profiling information of all the queued commands
+    typename Instrumentation::Recorder mRecorder;
+    /// Index of the profiled queue in mRecorder
+    unsigned int              mQueueIndex;
+    /// Profiling mode. Can be set with ProfilingMode option
+    unsigned long             mProfilingMode;
+    /// 1 command in mSampling is profiled. Can be set with ProfilingSampling option
+    unsigned long             mSampling;
+    /// Number of commands queued so far
+    unsigned long             mCommands;
+    /// Queue with profiling enabled used for sampled commands
+    cl::CommandQueue *        mProfiledQueue;
+    /// Queue on which the last command was queued
+    cl::CommandQueue *        mLastQueue;
+    /// Wait list used to order commands queued on different queues
+    std::vector<cl::Event>    mWaitList;
+    /// Programs already built in mContext, unless attached to a runtime
+    ProgramCache              mPrograms;
+    /// Buffers released in mContext, unless attached to a runtime
+    BufferPool                mBuffers;
+    /// Runtime the instance is attached to, if any
+    std::shared_ptr<SharedRuntime> mRuntime;
+    /// How the device is selected. Can be set with DeviceSelection option
+    unsigned long             mSelection;
+    /// Extensions the device must support. Can be set with RequiredExtensions option
+    std::string               mRequiredExtensions;
+    /// Function scoring the devices. Can be set with SetDeviceScorer()
+    DeviceScorer              mScorer;
+    /// Whether mPrograms is used. Can be set with ProgramCaching option
+    bool                      mProgramCaching;
+    /// Log of the last program build
+    std::string               mBuildLog;
+    /// Counters of everything done through the wrapper
+    WrapperCounters           mCounters;
+    /// Workload declared for the next kernel launch
+    KernelWorkload            mWorkload;
+    /// Bytes of the buffers passed to the next kernel launch
+    cl_ulong                  mCountedBytes;
+    /// Peak figures of the used device
+    DevicePeaks *             mPeaks;
+    /// Measured device profiles. Can be set with DeviceProfiles option
+    std::vector<DeviceProfile> mProfiles;
+    /// Whether kernels are placed on the fastest device. Can be set with DevicePlacement option
+    bool                      mPlacement;
+    /// Queues with profiling enabled on each device of mDevices, when placing kernels
+    std::vector<cl::CommandQueue> mPlacementQueues;
+    /// Index of each placement queue in mRecorder
+    std::vector<unsigned int> mPlacementIndices;
+    /// Measured host/device bandwidth of each placement device in GB/s, 0 if unknown
+    std::vector<double>       mPlacementBandwidths;
+    /// Tracker timing the kernels on each device, when placing kernels
+    PlacementTracker          mPlacer;
+    /// How the device is partitioned. Can be set with DevicePartition option
+    unsigned long             mPartition;
+    /// Compute units of each sub-device. Can be set with PartitionCounts option
+    std::vector<cl_uint>      mPartitionCounts;
+    /// Index of the used sub-device. Can be set with SubDevice option
+    unsigned long             mSubDevice;
+    /// Placement of host buffers. Can be set with NumaPolicy option
+    unsigned long             mNumaPolicy;
+    /// NUMA node of host buffers with NumaExplicit. Can be set with NumaNode option
+    int                       mNumaNode;
+    /// Queues used by EnqueueKernel(), a single one if out of order
+    std::vector<cl::CommandQueue> mConcurrentQueues;
+    /// Index of each concurrent queue in mRecorder
+    std::vector<unsigned int> mConcurrentIndices;
+    /// Number of in order concurrent queues. Can be set with ConcurrentQueues option
+    unsigned long             mConcurrency;
+    /// Concurrent queue on which the next kernel is queued
+    unsigned long             mConcurrentNext;
+    /// Whether kernels were queued by EnqueueKernel() since the last ordered command
+    bool                      mConcurrentPending;
+    /// Last ordered command, that the kernels queued by EnqueueKernel() wait for
+    cl::Event                 mOrderedEvent;
+
+    ///
+    /// \fn      BasicOpenCL
     /// \param   Ocl The OpenCL instance to copy
     /// \brief   Copy constructor
     /// \details Disallow the copy constructor
     ///
-    OpenCL(const OpenCL & Ocl) {
+    BasicOpenCL(const BasicOpenCL & Ocl) {
         // Do nothing
         (void)Ocl;
     }
@@ -68,7 +265,7 @@ private:
     /// \brief   Affectation operator
     /// \details Disallow the affectation operator
     ///
-    OpenCL & operator=(const OpenCL & Ocl) {
+    BasicOpenCL & operator=(const BasicOpenCL & Ocl) {
         // Do nothing
         (void)Ocl;
         return *this;
@@ -93,59 +290,138 @@ private:
     /// \details It will browse all the availables platforms and all the available
     ///          devices to find the most suitable. Its behaviour can be changed
     ///          with the SetParameter() function and the TargetDevice parameter.
+    ///          By default, the first suitable device is selected, looking at
+    ///          accelerators, then GPUs, then CPUs, in the platform order.
+    ///          With SelectionByScore, the device with the highest score is
+    ///          selected instead. On equal scores, the same order is kept. Platforms and devices
+    ///          are only enumerated once per process, by the DeviceRegistry.
+    ///          The context gets all the devices of the same type and platform
+    ///          as the selected one. When placing kernels, it gets all the
+    ///          suitable devices of the platform instead. When partitioning,
+    ///          it gets the sub-devices of the selected device only.
     ///
     cl_int InitializeDevices() {
-#define BROWSE_DEVICES(type)                                               \
-    for (unsigned int i = 0; i < Platforms.size(); i++) {                  \
-        Platforms[i].getDevices(CL_DEVICE_TYPE_##type, mDevices);          \
-        for (unsigned int j = 0; j < mDevices->size(); j++) {              \
-            if (mDevices->at(j).getInfo<CL_DEVICE_AVAILABLE>() &&          \
-                mDevices->at(j).getInfo<CL_DEVICE_COMPILER_AVAILABLE>()) { \
-                mDevice = j;                                               \
-                return CL_SUCCESS;                                         \
-            }                                                              \
-        }                                                                  \
-    }
+        static const cl_device_type Types[] = { CL_DEVICE_TYPE_ACCELERATOR,
+                                                CL_DEVICE_TYPE_GPU,
+                                                CL_DEVICE_TYPE_CPU };
+
+        const std::vector<DeviceInfo> & Devices = DeviceRegistry::Get().GetDevices();
+        const DeviceInfo * Selected = 0;
+        cl_device_type SelectedType = 0;
+        double BestScore = 0.0;
+
+        for (unsigned int i = 0; i < sizeof(Types) / sizeof(Types[0]); i++) {
+            if (mTargetDevice != CL_DEVICE_TYPE_ALL &&
+                !(mTargetDevice & (CL_DEVICE_TYPE_DEFAULT | Types[i]))) {
+                continue;
+            }
+
+            for (unsigned int j = 0; j < Devices.size(); j++) {
+                const DeviceInfo & Info = Devices[j];
+                if (!(Info.Type & Types[i]) || !Info.Available || !Info.CompilerAvailable ||
+                    !HasExtensions(Info, mRequiredExtensions)) {
+                    continue;
+                }
+
+                if (mSelection == SelectionByOrder) {
+                    Selected = &Info;
+                    SelectedType = Types[i];
+                    break;
+                }
+
+                double Score = mScorer(Info, FindDeviceProfile(mProfiles, Info.Name));
+                if (Score >= 0.0 && (Selected == 0 || Score > BestScore)) {
+                    Selected = &Info;
+                    SelectedType = Types[i];
+                    BestScore = Score;
+                }
+            }
 
-        std::vector<cl::Platform> Platforms;
+            if (Selected != 0 && mSelection == SelectionByOrder) {
+                break;
+            }
+        }
+
+        if (Selected == 0) {
+            return CL_DEVICE_NOT_FOUND;
+        }
+
+        if (mPartition != PartitionOff) {
+            return InitializeSubDevices(Selected->Device);
+        }
 
         mDevices = new (std::nothrow) std::vector<cl::Device>;
         if (mDevices == 0) {
             return CL_OUT_OF_HOST_MEMORY;
         }
-        cl::Platform::get(&Platforms);
 
-        //
-        // First, browse for accelerator
-        //
-        if (mTargetDevice == CL_DEVICE_TYPE_ALL || mTargetDevice &
-            (CL_DEVICE_TYPE_DEFAULT | CL_DEVICE_TYPE_ACCELERATOR)) {
-            BROWSE_DEVICES(ACCELERATOR)
+        for (unsigned int j = 0; j < Devices.size(); j++) {
+            const DeviceInfo & Info = Devices[j];
+            if (Info.Platform != Selected->Platform) {
+                continue;
+            }
+
+            bool Used = (mPlacement ? (Info.Available && Info.CompilerAvailable &&
+                                       HasExtensions(Info, mRequiredExtensions)) :
+                                      (Info.Type & SelectedType) != 0);
+            if (Used) {
+                if (&Info == Selected) {
+                    mDevice = mDevices->size();
+                }
+                mDevices->push_back(Info.Device);
+            }
         }
 
-        //
-        // Then, GPU
-        //
-        if (mTargetDevice == CL_DEVICE_TYPE_ALL || mTargetDevice &
-            (CL_DEVICE_TYPE_DEFAULT | CL_DEVICE_TYPE_GPU)) {
-            BROWSE_DEVICES(GPU)
+        return CL_SUCCESS;
+    }
+
+    ///
+    /// \fn      InitializeSubDevices
+    /// \param   Device The device to partition
+    /// \return  Any of the OpenCL cl::Device::createSubDevices error code,
+    ///          CL_OUT_OF_HOST_MEMORY and CL_DEVICE_NOT_FOUND
+    /// \brief   This function is used to partition the selected device
+    /// \details The context gets all the sub-devices, so that buffers are
+    ///          shared between them, and the one selected with the SubDevice
+    ///          option is used. With the DevicePlacement option, kernels are
+    ///          placed on all of them, each getting its own queue.
+    ///          CL_DEVICE_NOT_FOUND is returned if there is no such
+    ///          sub-device.
+    ///
+    cl_int InitializeSubDevices(const cl::Device & Device) {
+        std::vector<cl_device_partition_property> Properties;
+
+        if (mPartition == PartitionByNuma) {
+            Properties.push_back(CL_DEVICE_PARTITION_BY_AFFINITY_DOMAIN);
+            Properties.push_back(CL_DEVICE_AFFINITY_DOMAIN_NUMA);
+        } else {
+            if (mPartitionCounts.empty()) {
+                return CL_INVALID_DEVICE_PARTITION_COUNT;
+            }
+
+            Properties.push_back(CL_DEVICE_PARTITION_BY_COUNTS);
+            Properties.insert(Properties.end(), mPartitionCounts.begin(), mPartitionCounts.end());
+            Properties.push_back(CL_DEVICE_PARTITION_BY_COUNTS_LIST_END);
         }
+        Properties.push_back(0);
 
-        //
-        // Finally, CPU
-        //
-        if (mTargetDevice == CL_DEVICE_TYPE_ALL || mTargetDevice &
-            (CL_DEVICE_TYPE_DEFAULT | CL_DEVICE_TYPE_CPU)) {
-            BROWSE_DEVICES(CPU)
+        std::vector<cl::Device> SubDevices;
+        cl_int Error = cl::Device(Device).createSubDevices(&Properties[0], &SubDevices);
+        if (Error != CL_SUCCESS) {
+            return Error;
         }
 
-        //
-        // In case no device was found ensure we reset mDevices
-        //
-        delete mDevices;
-        mDevices = 0;
+        if (mSubDevice >= SubDevices.size()) {
+            return CL_DEVICE_NOT_FOUND;
+        }
+
+        mDevices = new (std::nothrow) std::vector<cl::Device>(SubDevices);
+        if (mDevices == 0) {
+            return CL_OUT_OF_HOST_MEMORY;
+        }
+        mDevice = mSubDevice;
 
-        return CL_DEVICE_NOT_FOUND;
+        return CL_SUCCESS;
     }
 
     ///
@@ -181,6 +457,13 @@ private:
     /// \return  Any of the OpenCL cl::CommandQueue error code and CL_OUT_OF_HOST_MEMORY
     /// \brief   This function is used to initialize the OpenCL queue
     /// \details It will first look for devices and initialize context if required.
+    ///          Profiling is only enabled on the queue if all the commands are
+    ///          profiled. When sampling, a second queue with profiling enabled
+    ///          is created for the sampled commands, so that the other ones
+    ///          don't pay for profiling. When attached to a runtime, its
+    ///          queues are used instead. When placing kernels, a queue with
+    ///          profiling enabled is also created on each device, attached
+    ///          or not.
     ///
     cl_int InitializeQueue() {
         INIT(Context);
@@ -188,9 +471,14 @@ private:
         assert(mDevices != 0);
         assert(mContext != 0);
 
+        if (mRuntime) {
+            return InitializeSharedQueue();
+        }
+
         cl_int Error;
         mQueue = new (std::nothrow) cl::CommandQueue(*mContext, mDevices->at(mDevice),
-                                                     CL_QUEUE_PROFILING_ENABLE,
+                                                     (mProfilingMode == ProfilingAlways ?
+                                                      CL_QUEUE_PROFILING_ENABLE : 0),
                                                      &Error);
         if (mQueue == 0) {
             return CL_OUT_OF_HOST_MEMORY;
@@ -202,23 +490,413 @@ private:
         if (Error != CL_SUCCESS) {
             delete mQueue;
             mQueue = 0;
+            return Error;
+        }
+
+        if (mProfilingMode == ProfilingSampled) {
+            mProfiledQueue = new (std::nothrow) cl::CommandQueue(*mContext, mDevices->at(mDevice),
+                                                                 CL_QUEUE_PROFILING_ENABLE,
+                                                                 &Error);
+            if (mProfiledQueue == 0) {
+                Error = CL_OUT_OF_HOST_MEMORY;
+            }
+
+            //
+            // In case of error ensure we reset both queues
+            //
+            if (Error != CL_SUCCESS) {
+                delete mProfiledQueue;
+                mProfiledQueue = 0;
+                delete mQueue;
+                mQueue = 0;
+                return Error;
+            }
+        }
+
+        if (mProfilingMode != ProfilingOff) {
+            mQueueIndex = mRecorder.RegisterQueue(mDevices->at(mDevice).getInfo<CL_DEVICE_NAME>());
+        }
+
+        if (mPlacement && mDevices->size() > 1) {
+            Error = InitializePlacementQueues();
+            if (Error != CL_SUCCESS) {
+                delete mProfiledQueue;
+                mProfiledQueue = 0;
+                delete mQueue;
+                mQueue = 0;
+            }
         }
 
         return Error;
     }
 
     ///
-    /// \fn      ExecuteKernelFromKernelEx
-    /// \param   Kernel   The kernel to execute
-    /// \param   DataSize Size of data on which the kernel will work
-    /// \param   Position Unused
+    /// \fn      InitializePlacementQueues
+    /// \return  Any of the OpenCL cl::CommandQueue error code
+    /// \brief   This function is used to create a queue on each device of the context
+    /// \details Those queues have profiling enabled, as the placement
+    ///          relies on timing the kernels. The transfer bandwidth of each
+    ///          device is taken from its profile, if one was loaded with the
+    ///          DeviceProfiles option.
+    ///
+    cl_int InitializePlacementQueues() {
+        cl_int Error = CL_SUCCESS;
+
+        mPlacementQueues.clear();
+        mPlacementIndices.clear();
+        mPlacementBandwidths.clear();
+
+        for (unsigned int i = 0; i < mDevices->size(); i++) {
+            cl::CommandQueue Queue(*mContext, mDevices->at(i), CL_QUEUE_PROFILING_ENABLE, &Error);
+            if (Error != CL_SUCCESS) {
+                mPlacementQueues.clear();
+                mPlacementIndices.clear();
+                return Error;
+            }
+
+            std::string Name = mDevices->at(i).getInfo<CL_DEVICE_NAME>();
+            const DeviceProfile * Profile = FindDeviceProfile(mProfiles, Name);
+
+            mPlacementQueues.push_back(Queue);
+            mPlacementIndices.push_back(mProfilingMode != ProfilingOff ? mRecorder.RegisterQueue(Name) : 0);
+            mPlacementBandwidths.push_back(Profile != 0 ? Profile->TransferBandwidth : 0.0);
+        }
+
+        mPlacer.Reset(mDevices->size());
+
+        return CL_SUCCESS;
+    }
+
+    ///
+    /// \fn      GetTransferCost
+    /// \param   Device Index in mDevices of the device the kernel is placed on
+    /// \param   Bytes  Bytes of the buffers passed to the kernel
+    /// \return  The time in ns to move the buffers to the device and back
+    /// \details Buffers are written and read on the used device, so a kernel
+    ///          placed there doesn't move them. The cost is 0 if the bandwidth
+    ///          of the device wasn't measured.
+    ///
+    cl_ulong GetTransferCost(unsigned int Device, cl_ulong Bytes) const {
+        if (Device == mDevice || !(mPlacementBandwidths[Device] > 0.0)) {
+            return 0;
+        }
+
+        return static_cast<cl_ulong>(2.0 * Bytes / mPlacementBandwidths[Device]);
+    }
+
+    ///
+    /// \fn      InitializeConcurrentQueues
+    /// \return  Any of the OpenCL cl::CommandQueue error code
+    /// \brief   This function is used to create the queues of EnqueueKernel()
+    /// \details If the device supports it, a single out of order queue is
+    ///          created. Otherwise, several in order queues are created, so
+    ///          that independent kernels can still overlap. Profiling is
+    ///          enabled on all of them, unless it is off.
+    ///
+    cl_int InitializeConcurrentQueues() {
+        const cl::Device & Device = mDevices->at(mDevice);
+        cl_command_queue_properties Properties = (mProfilingMode != ProfilingOff ?
+                                                  CL_QUEUE_PROFILING_ENABLE : 0);
+        unsigned long Queues = mConcurrency;
+        cl_int Error = CL_SUCCESS;
+
+        if (Device.getInfo<CL_DEVICE_QUEUE_PROPERTIES>() & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE) {
+            Properties |= CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE;
+            Queues = 1;
+        }
+
+        for (unsigned long i = 0; i < Queues; i++) {
+            cl::CommandQueue Queue(*mContext, Device, Properties, &Error);
+            if (Error != CL_SUCCESS) {
+                mConcurrentQueues.clear();
+                mConcurrentIndices.clear();
+                return Error;
+            }
+
+            mConcurrentQueues.push_back(Queue);
+            mConcurrentIndices.push_back(mProfilingMode != ProfilingOff ?
+                                         mRecorder.RegisterQueue(Device.getInfo<CL_DEVICE_NAME>()) :
+                                         0);
+        }
+
+        mConcurrentNext = 0;
+
+        return CL_SUCCESS;
+    }
+
+    ///
+    /// \fn      InitializeSharedQueue
+    /// \return  Any of the OpenCL cl::CommandQueue error code
+    /// \brief   This function is used to get the queues from the attached runtime
+    /// \details Queues are shared with all the instances attached to the
+    ///          runtime that use the same profiling mode. Placement queues
+    ///          are per instance, on the devices of the runtime.
+    ///
+    cl_int InitializeSharedQueue() {
+        assert(mRuntime);
+
+        cl_int Error = mRuntime->GetQueue((mProfilingMode == ProfilingAlways ?
+                                           CL_QUEUE_PROFILING_ENABLE : 0), mQueue);
+        if (Error == CL_SUCCESS && mProfilingMode == ProfilingSampled) {
+            Error = mRuntime->GetQueue(CL_QUEUE_PROFILING_ENABLE, mProfiledQueue);
+        }
+
+        //
+        // In case of error ensure we reset both queues
+        //
+        if (Error != CL_SUCCESS) {
+            mQueue = 0;
+            mProfiledQueue = 0;
+            return Error;
+        }
+
+        if (mProfilingMode != ProfilingOff) {
+            mQueueIndex = mRecorder.RegisterQueue(mDevices->at(mDevice).getInfo<CL_DEVICE_NAME>());
+        }
+
+        if (mPlacement && mDevices->size() > 1) {
+            Error = InitializePlacementQueues();
+            if (Error != CL_SUCCESS) {
+                mQueue = 0;
+                mProfiledQueue = 0;
+                return Error;
+            }
+        }
+
+        return CL_SUCCESS;
+    }
+
+    ///
+    /// \fn      GetProgramCache
+    /// \return  The cache of the programs, shared if attached to a runtime
+    ///
+    ProgramCache & GetProgramCache() {
+        return (mRuntime ? mRuntime->GetPrograms() : mPrograms);
+    }
+
+    ///
+    /// \fn      GetBufferPool
+    /// \return  The pool of the buffers, shared if attached to a runtime
+    ///
+    BufferPool & GetBufferPool() {
+        return (mRuntime ? mRuntime->GetBuffers() : mBuffers);
+    }
+
+    ///
+    /// \fn      UpdateBuildLog
+    /// \param   Program The program that was just built
+    /// \brief   This function retrieves the build log of a program
+    /// \details Logs of all the devices the program was built for are
+    ///          concatenated. Logs only made of blanks are dropped.
+    ///
+    void UpdateBuildLog(const cl::Program & Program) {
+        mBuildLog.clear();
+
+        for (unsigned int i = 0; i < mDevices->size(); i++) {
+            std::string Log = Program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(mDevices->at(i));
+            if (Log.find_first_not_of(" \t\r\n", 0) == std::string::npos) {
+                continue;
+            }
+
+            if (mDevices->size() > 1) {
+                mBuildLog += mDevices->at(i).getInfo<CL_DEVICE_NAME>() + ":\n";
+            }
+
+            mBuildLog += Log;
+        }
+    }
+
+    ///
+    /// \fn      RecordBuild
+    /// \param   SourceSize  Length of the program source code
+    /// \param   CacheHit    Whether the program was found in the cache
+    /// \param   CreateBegin Host time before creating the program
+    /// \param   BuildBegin  Host time before building the program
+    /// \param   BuildEnd    Host time after building the program
+    /// \param   Status      Result of the creation and build
+    /// \brief   This function records the telemetry of a program build
+    ///
+    void RecordBuild(size_t SourceSize, bool CacheHit, cl_ulong CreateBegin,
+                     cl_ulong BuildBegin, cl_ulong BuildEnd, cl_int Status) {
+        if (!Instrumentation::Enabled) {
+            return;
+        }
+
+        BuildRecord Build;
+        Build.SourceSize = SourceSize;
+        Build.Options = mBuildOptions;
+        Build.Device = mDevices->at(mDevice).getInfo<CL_DEVICE_NAME>();
+        Build.CacheHit = CacheHit;
+        Build.CreateTime = GetElapsed(CreateBegin, BuildBegin);
+        Build.BuildTime = GetElapsed(BuildBegin, BuildEnd);
+        Build.Status = Status;
+        Build.Log = (CacheHit ? "" : mBuildLog);
+
+        mRecorder.RecordBuild(Build);
+    }
+
+    ///
+    /// \fn      IsNextProfiled
+    /// \return  true if the next command will be profiled, false otherwise
+    /// \brief   This function tells what SelectQueue() will decide next
+    /// \details When sampling, 1 command in mSampling is profiled.
+    ///
+    bool IsNextProfiled() const {
+        if (mProfilingMode == ProfilingSampled) {
+            return (mCommands % mSampling == 0);
+        }
+
+        return (mProfilingMode == ProfilingAlways);
+    }
+
+    ///
+    /// \fn      SelectQueue
+    /// \param   Queue Queue on which the next command has to be queued
+    /// \return  true if the next command has to be profiled, false otherwise
+    /// \brief   This function selects the queue for the next command
+    /// \details When sampling, 1 command in mSampling goes to the profiled queue.
+    ///
+    bool SelectQueue(cl::CommandQueue *& Queue) {
+        bool Profiled = IsNextProfiled();
+
+        mCommands++;
+        Queue = ((Profiled && mProfiledQueue != 0) ? mProfiledQueue : mQueue);
+
+        return Profiled;
+    }
+
+    ///
+    /// \fn      GetWaitList
+    /// \param   Queue Queue on which the next command will be queued
+    /// \return  The wait list to use for the next command, 0 if none
+    /// \brief   This function keeps commands ordered across queues
+    /// \details Queues are in order, but there is no ordering between two
+    ///          queues. When switching queue, the next command has to wait
+    ///          for the last one. After EnqueueKernel(), it has to wait for
+    ///          all the kernels still outstanding on the concurrent queues: a
+    ///          marker is queued on each of them, or the queue is finished if
+    ///          the marker can't be queued.
+    ///
+    const std::vector<cl::Event> * GetWaitList(cl::CommandQueue * Queue) {
+        if (mConcurrentPending) {
+            mWaitList.clear();
+            for (size_t i = 0; i < mConcurrentQueues.size(); i++) {
+                cl::Event Marker;
+                if (mConcurrentQueues[i].enqueueMarkerWithWaitList(0, &Marker) == CL_SUCCESS) {
+                    mWaitList.push_back(Marker);
+                } else {
+                    mConcurrentQueues[i].finish();
+                }
+            }
+
+            return (mWaitList.empty() ? 0 : &mWaitList);
+        }
+
+        if (mLastQueue == 0 || mLastQueue == Queue) {
+            return 0;
+        }
+
+        mWaitList.assign(1, mEvent);
+        return &mWaitList;
+    }
+
+    ///
+    /// \fn      SetLastCommand
+    /// \param   Queue Queue on which the command in mEvent was queued
+    /// \brief   This function records the last ordered command
+    /// \details Kernels queued by EnqueueKernel() afterwards wait for it.
+    ///
+    void SetLastCommand(cl::CommandQueue * Queue) {
+        mLastQueue = Queue;
+        mOrderedEvent = mEvent;
+        mConcurrentPending = false;
+    }
+
+    ///
+    /// \fn      GetHostPlacement
+    /// \param   Policy Placement of the host buffers, see NumaPolicies
+    /// \param   Node   NUMA node of the host buffers, -1 for the node of the calling thread
+    /// \return  CL_SUCCESS, CL_INVALID_OPERATION
+    /// \brief   This function tells where host buffers are placed
+    /// \details Host buffers are only placed when the used device is a CPU.
+    ///          OpenCL doesn't tell which cores a sub-device runs on, so the
+    ///          node of a sub-device of a partition by NUMA node can't be
+    ///          established. NumaLocal is then rejected if there are several
+    ///          nodes: NumaExplicit with NumaNode has to be used instead.
+    ///
+    cl_int GetHostPlacement(unsigned long & Policy, int & Node) {
+        Policy = mNumaPolicy;
+        Node = -1;
+
+        if (!(mDevices->at(mDevice).getInfo<CL_DEVICE_TYPE>() & CL_DEVICE_TYPE_CPU)) {
+            Policy = NumaOff;
+        } else if (Policy == NumaExplicit) {
+            Node = mNumaNode;
+        } else if (Policy == NumaLocal && mPartition == PartitionByNuma && GetNumaNodes() > 1) {
+            return CL_INVALID_OPERATION;
+        }
+
+        return CL_SUCCESS;
+    }
+
+    ///
+    /// \fn      InitializePeaks
+    /// \return  Any of the OpenCL cl::Device::getInfo error code and CL_OUT_OF_HOST_MEMORY
+    /// \brief   This function is used to estimate the peak figures of the used device
+    /// \details The compute peak is estimated by GetEstimatedGflops(). No query provides the
+    ///          bandwidth peaks, they are left unknown unless they are set
+    ///          with SetDevicePeaks(). If a measured profile of the device
+    ///          was loaded with the DeviceProfiles option, its figures are
+    ///          used instead. It will first look for devices if required.
+    ///
+    cl_int InitializePeaks() {
+        INIT(Devices);
+
+        assert(mDevices != 0);
+
+        const cl::Device & Device = mDevices->at(mDevice);
+        const DeviceProfile * Profile = FindDeviceProfile(mProfiles,
+                                                          Device.getInfo<CL_DEVICE_NAME>());
+        if (Profile != 0) {
+            mPeaks = new (std::nothrow) DevicePeaks(GetProfilePeaks(*Profile));
+            return (mPeaks == 0 ? CL_OUT_OF_HOST_MEMORY : CL_SUCCESS);
+        }
+
+        DeviceInfo Info;
+        cl_int Error = DeviceRegistry::Get().GetDeviceInfo(Device, Info);
+        if (Error != CL_SUCCESS) {
+            return Error;
+        }
+
+        mPeaks = new (std::nothrow) DevicePeaks;
+        if (mPeaks == 0) {
+            return CL_OUT_OF_HOST_MEMORY;
+        }
+
+        mPeaks->ComputeGflops = GetEstimatedGflops(Info);
+        mPeaks->MemoryBandwidth = 0.0;
+        mPeaks->TransferBandwidth = 0.0;
+
+        return CL_SUCCESS;
+    }
+
+    ///
+    /// \fn      ExecuteKernelOnRangeEx
+    /// \param   Kernel     The kernel to execute
+    /// \param   GlobalSize Number of work-items
+    /// \param   LocalSize  Number of work-items per work-group
+    /// \param   Position   Unused
     /// \return  Any of the OpenCL code for cl::Queue::enqueueNDRangeKernel
     /// \brief   This function queues any kernel for its execution on the target device
-    /// \details According to the given DataSize it will compute an appropriate
-    ///          grid size and queue the work item. An event is used for profiling.
-    ///
-    cl_int ExecuteKernelFromKernelEx(cl::Kernel & Kernel, long DataSize,
-                                     long Position) {
+    /// \details The work items are queued with the given grid size. An event
+    ///          is used for profiling. The workload declared for the launch,
+    ///          if any, is recorded along with it. If no byte was declared,
+    ///          the size of the buffer arguments is recorded instead. When
+    ///          placing kernels, those bytes also give the transfer cost of
+    ///          running on another device than the used one.
+    ///
+    cl_int ExecuteKernelOnRangeEx(cl::Kernel & Kernel, const cl::NDRange & GlobalSize,
+                                  const cl::NDRange & LocalSize, long Position) {
         INIT(Queue);
 
         assert(mDevices != 0);
@@ -227,11 +905,99 @@ private:
 
         (void)Position;
 
+        KernelWorkload Workload = mWorkload;
+        if (Workload.Bytes == 0) {
+            Workload.Bytes = mCountedBytes;
+        }
+        mWorkload.Flops = mWorkload.Bytes = 0;
+        mCountedBytes = 0;
+
+        cl::CommandQueue * Queue;
+        bool Profiled = SelectQueue(Queue);
+        unsigned int QueueIndex = mQueueIndex;
+
+        //
+        // The name is queried once, before the launch is timed. When placing
+        // kernels, the placement queues are all profiled
+        //
+        std::string Name;
+        if (!mPlacementQueues.empty() || (Instrumentation::Enabled && Profiled)) {
+            Name = Kernel.getInfo<CL_KERNEL_FUNCTION_NAME>();
+        }
+
+        unsigned int Placed = 0;
+        if (!mPlacementQueues.empty()) {
+            Placed = mPlacer.Select(Name);
+            Queue = &mPlacementQueues[Placed];
+            QueueIndex = mPlacementIndices[Placed];
+        }
+
+        cl_ulong HostBegin = (Instrumentation::Enabled && Profiled ? GetHostTime() : 0);
+        cl_int Error = Queue->enqueueNDRangeKernel(Kernel, cl::NullRange, GlobalSize,
+                                                   LocalSize, GetWaitList(Queue), &mEvent);
+        cl_ulong HostEnd = (Instrumentation::Enabled && Profiled ? GetHostTime() : 0);
+        if (Error == CL_SUCCESS) {
+            SetLastCommand(Queue);
+            if (Instrumentation::Enabled) {
+                mCounters.KernelLaunches++;
+            }
+
+            if (!mPlacementQueues.empty()) {
+                mPlacer.Track(Name, Placed, mEvent, GetTransferCost(Placed, Workload.Bytes));
+            }
+
+            if (Instrumentation::Enabled && Profiled) {
+                mRecorder.Record(KernelCommand, Name, Workload.Bytes, Workload.Flops,
+                                 GlobalSize, LocalSize, mEvent, QueueIndex, HostBegin, HostEnd);
+            }
+        }
+
+        return Error;
+    }
+
+    ///
+    /// \fn      ExecuteKernelOnRangeEx
+    /// \tparam  Arg        Type of the next kernel argument to queue
+    /// \tparam  Args       Types of the last kernel arguments to queue
+    /// \param   Kernel     The kernel to execute
+    /// \param   GlobalSize Number of work-items
+    /// \param   LocalSize  Number of work-items per work-group
+    /// \param   Position   Position of the next argument for the kernel arguments
+    /// \param   KernelArg  Next kernel argument to queue
+    /// \param   KernelArgs Last kernels arguments to queue
+    /// \return  Any of the OpenCL code for cl::Queue::enqueueNDRangeKernel
+    /// \brief   This function queues any kernel for its execution on the target device
+    /// \details The work items are queued with the given grid size. But first,
+    ///          it will queue all the provided kernel arguments, counting the
+    ///          bytes of the buffers if the launch will be profiled or placed.
+    ///
+    template<typename Arg, typename... Args>
+    cl_int ExecuteKernelOnRangeEx(cl::Kernel & Kernel, const cl::NDRange & GlobalSize,
+                                  const cl::NDRange & LocalSize, long Position,
+                                  const Arg& KernelArg, const Args&... KernelArgs) {
+        Kernel.setArg(Position, KernelArg);
+        if (mPlacement || (Instrumentation::Enabled && IsNextProfiled())) {
+            mCountedBytes += GetArgumentBytes(KernelArg);
+        }
+        return ExecuteKernelOnRangeEx(Kernel, GlobalSize, LocalSize, Position + 1, KernelArgs...);
+    }
+
+    ///
+    /// \fn      ExecuteKernelFromKernelEx
+    /// \param   Kernel   The kernel to execute
+    /// \param   DataSize Size of data on which the kernel will work
+    /// \param   Position Position of the next argument for the kernel arguments
+    /// \return  Any of the OpenCL code for cl::Queue::enqueueNDRangeKernel
+    /// \brief   This function queues any kernel for its execution on the target device
+    /// \details According to the given DataSize it will compute an appropriate
+    ///          grid size and queue the work item. An event is used for profiling.
+    ///
+    cl_int ExecuteKernelFromKernelEx(cl::Kernel & Kernel, long DataSize,
+                                     long Position) {
         cl::NDRange GlobalSize, LocalSize;
         GetGridSize(LocalSize, GlobalSize, DataSize);
 
-        return mQueue->enqueueNDRangeKernel(Kernel, cl::NullRange, GlobalSize,
-                                            LocalSize, 0, &mEvent);
+        return ExecuteKernelOnRangeEx(Kernel, GlobalSize, LocalSize, Position);
     }
 
     ///
@@ -247,62 +1013,321 @@ private:
     /// \brief   This function queues any kernel for its execution on the target device
     /// \details According to the given DataSize it will compute an appropriate
     ///          grid size and queue the work item. An event is used for profiling.
-    ///          But first, it will queue all the provided kernel arguments.
+    ///          But first, it will queue all the provided kernel arguments,
+    ///          counting the bytes of the buffers if the launch will be profiled
+    ///          or placed.
     ///
     template<typename Arg, typename... Args>
     cl_int ExecuteKernelFromKernelEx(cl::Kernel & Kernel, long DataSize,
                                      long Position, const Arg& KernelArg,
                                      const Args&... KernelArgs) {
         Kernel.setArg(Position, KernelArg);
+        if (mPlacement || (Instrumentation::Enabled && IsNextProfiled())) {
+            mCountedBytes += GetArgumentBytes(KernelArg);
+        }
         return ExecuteKernelFromKernelEx(Kernel, DataSize, Position + 1, KernelArgs...);
     }
 
 public:
     ///
-    /// \fn      OpenCL
+    /// \fn      BasicOpenCL
     /// \brief   Constructor that simply initialized dummy context
     /// \details By default, no build option will be set and the class will look
-    ///          for any suitable device to run on.
+    ///          for any suitable device to run on. All the commands will be
+    ///          profiled, unless instrumentation is disabled.
     ///
-    OpenCL() {
+    BasicOpenCL() {
         mTargetDevice = CL_DEVICE_TYPE_ALL;
         mBuildOptions = "";
         mContext = 0;
         mDevices = 0;
         mDevice = 0;
         mQueue = 0;
+        mQueueIndex = 0;
+        mWorkload.Flops = 0;
+        mWorkload.Bytes = 0;
+        mCountedBytes = 0;
+        mPeaks = 0;
+        mProfilingMode = (Instrumentation::Enabled ? ProfilingAlways : ProfilingOff);
+        mSampling = 1;
+        mCommands = 0;
+        mProfiledQueue = 0;
+        mLastQueue = 0;
+        mProgramCaching = true;
+        mSelection = SelectionByOrder;
+        mRequiredExtensions = "";
+        mScorer = GetDefaultDeviceScore;
+        mPlacement = false;
+        mPartition = PartitionOff;
+        mSubDevice = 0;
+        mNumaPolicy = NumaOff;
+        mNumaNode = 0;
+        mConcurrency = 4;
+        mConcurrentNext = 0;
+        mConcurrentPending = false;
+        mCounters.KernelLaunches = 0;
+        mCounters.BytesRead = 0;
+        mCounters.BytesWritten = 0;
+        mCounters.BytesAllocated = 0;
     }
 
     ///
-    /// \fn    ~OpenCL
-    /// \brief Destructor that simply release everything related to context
+    /// \fn      ~BasicOpenCL
+    /// \brief   Destructor that simply release everything related to context
+    /// \details When attached to a runtime, the context and queues belong to
+    ///          it and are only released with the last attached instance.
     ///
-    ~OpenCL() {
-        delete mContext;
-        delete mDevices;
-        delete mQueue;
+    ~BasicOpenCL() {
+        if (!mRuntime) {
+            delete mContext;
+            delete mDevices;
+            delete mQueue;
+            delete mProfiledQueue;
+        }
+        delete mPeaks;
     }
 
     ///
-    /// \fn     AllocateBuffer
-    /// \tparam T      Type of the elements in the buffer
-    /// \param  Size   Number of elements in the buffer
-    /// \param  Buffer Output buffer that will be allocated
-    /// \return Any of the cl::Buffer error code
-    /// \brief  Allocates a buffer on the target device
+    /// \fn      GetRuntime
+    /// \param   Runtime Runtime the instance is attached to
+    /// \return  Any of the OpenCL cl::Context error code and CL_OUT_OF_HOST_MEMORY
+    /// \brief   This function returns a runtime other instances can attach to
+    /// \details If the instance isn't attached to a runtime yet, one is
+    ///          created from its context and queues, and the instance is
+    ///          attached to it. Programs built before aren't shared. It will
+    ///          initialize a context first if required.
+    /// \see     AttachRuntime()
     ///
-    template<typename T>
-    cl_int AllocateBuffer(size_t Size, cl::Buffer & Buffer) {
+    cl_int GetRuntime(std::shared_ptr<SharedRuntime> & Runtime) {
         INIT(Context);
 
         assert(mDevices != 0);
         assert(mContext != 0);
 
-        cl_int Error;
+        if (!mRuntime) {
+            std::shared_ptr<SharedRuntime> Created;
+            try {
+                Created = std::make_shared<SharedRuntime>(*mDevices, mDevice, *mContext);
+            } catch (const std::bad_alloc &) {
+                return CL_OUT_OF_HOST_MEMORY;
+            }
+
+            //
+            // Hand over the context and the queues to the runtime
+            //
+            if (mQueue != 0) {
+                cl::CommandQueue * Queue = Created->AddQueue((mProfilingMode == ProfilingAlways ?
+                                                              CL_QUEUE_PROFILING_ENABLE : 0),
+                                                             *mQueue);
+                if (mLastQueue == mQueue) {
+                    mLastQueue = Queue;
+                }
+                delete mQueue;
+                mQueue = Queue;
+            }
+
+            if (mProfiledQueue != 0) {
+                cl::CommandQueue * Queue = Created->AddQueue(CL_QUEUE_PROFILING_ENABLE,
+                                                             *mProfiledQueue);
+                if (mLastQueue == mProfiledQueue) {
+                    mLastQueue = Queue;
+                }
+                delete mProfiledQueue;
+                mProfiledQueue = Queue;
+            }
+
+            delete mContext;
+            delete mDevices;
+            mContext = &Created->GetContext();
+            mDevices = &Created->GetDevices();
+            mRuntime = Created;
+        }
+
+        Runtime = mRuntime;
+
+        return CL_SUCCESS;
+    }
+
+    ///
+    /// \fn      AttachRuntime
+    /// \param   Runtime Runtime to attach to
+    /// \return  CL_SUCCESS, CL_INVALID_OPERATION, CL_INVALID_VALUE
+    /// \brief   This function makes the instance use a shared runtime
+    /// \details The instance then uses the device, context, queues, program
+    ///          cache and buffer pool of the runtime, so that buffers and
+    ///          programs can be passed between attached instances and no
+    ///          context is created. Profiling, counters, build options and
+    ///          placement stay per instance, placement using the devices of
+    ///          the runtime.
+    /// \warning The runtime can only be attached if no device was selected
+    ///          and DevicePartition wasn't set, as the devices of the runtime
+    ///          are already chosen
+    ///
+    cl_int AttachRuntime(const std::shared_ptr<SharedRuntime> & Runtime) {
+        if (!Runtime) {
+            return CL_INVALID_VALUE;
+        }
+
+        if (mDevices != 0 || mPartition != PartitionOff) {
+            return CL_INVALID_OPERATION;
+        }
+
+        mRuntime = Runtime;
+        mDevices = &Runtime->GetDevices();
+        mDevice = Runtime->GetDevice();
+        mContext = &Runtime->GetContext();
+
+        return CL_SUCCESS;
+    }
+
+    ///
+    /// \fn     AllocateBuffer
+    /// \tparam T      Type of the elements in the buffer
+    /// \param  Size   Number of elements in the buffer
+    /// \param  Buffer Output buffer that will be allocated
+    /// \return Any of the cl::Buffer error code
+    /// \brief  Allocates a buffer on the target device
+    ///
+    template<typename T>
+    cl_int AllocateBuffer(size_t Size, cl::Buffer & Buffer) {
+        INIT(Context);
+
+        assert(mDevices != 0);
+        assert(mContext != 0);
+
+        cl_int Error;
         Buffer = cl::Buffer(*mContext, CL_MEM_READ_WRITE, sizeof(T) * Size, 0, &Error);
+        if (Instrumentation::Enabled && Error == CL_SUCCESS) {
+            mCounters.BytesAllocated += sizeof(T) * Size;
+        }
+
         return Error;
     }
 
+    ///
+    /// \fn     AllocateHostBuffer
+    /// \tparam T      Type of the elements in the buffer
+    /// \param  Size   Number of elements in the buffer
+    /// \param  Buffer Output buffer that will be allocated
+    /// \param  Host   Host memory backing the buffer
+    /// \return Any of the cl::Buffer error code, CL_OUT_OF_HOST_MEMORY, CL_INVALID_VALUE and CL_INVALID_OPERATION
+    /// \brief  Allocates a buffer backed by host memory placed on NUMA nodes
+    /// \details The buffer is created with CL_MEM_USE_HOST_PTR, so that CPU
+    ///          devices use the host memory without any copy. The memory is
+    ///          placed according to the NumaPolicy option and is freed with
+    ///          the buffer.
+    /// \warning The host memory must only be accessed while no command uses
+    ///          the buffer
+    ///
+    template<typename T>
+    cl_int AllocateHostBuffer(size_t Size, cl::Buffer & Buffer, T *& Host) {
+        INIT(Context);
+
+        assert(mDevices != 0);
+        assert(mContext != 0);
+
+        unsigned long Policy;
+        int Node;
+        cl_int Error = GetHostPlacement(Policy, Node);
+        if (Error != CL_SUCCESS) {
+            return Error;
+        }
+
+        HostMemory * Memory = new (std::nothrow) HostMemory;
+        if (Memory == 0) {
+            return CL_OUT_OF_HOST_MEMORY;
+        }
+
+        Error = AllocateHostMemory(sizeof(T) * Size, Policy, Node, *Memory);
+        if (Error != CL_SUCCESS) {
+            delete Memory;
+            return Error;
+        }
+
+        Buffer = cl::Buffer(*mContext, CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, sizeof(T) * Size,
+                            Memory->Pointer, &Error);
+        if (Error == CL_SUCCESS) {
+            Error = Buffer.setDestructorCallback(ReleaseHostMemory, Memory);
+        }
+
+        //
+        // In case of error ensure we free the memory once unused
+        //
+        if (Error != CL_SUCCESS) {
+            Buffer = cl::Buffer();
+            FreeHostMemory(*Memory);
+            delete Memory;
+            return Error;
+        }
+
+        Host = static_cast<T *>(Memory->Pointer);
+        if (Instrumentation::Enabled) {
+            mCounters.BytesAllocated += sizeof(T) * Size;
+        }
+
+        return CL_SUCCESS;
+    }
+
+    ///
+    /// \fn     AllocatePinnedBuffer
+    /// \tparam T      Type of the elements in the buffer
+    /// \param  Size   Number of elements in the buffer
+    /// \param  Buffer Output buffer that will be allocated
+    /// \return Any of the cl::Buffer error code
+    /// \brief  Allocates a buffer in pinned host memory
+    /// \details The buffer is created with CL_MEM_ALLOC_HOST_PTR, so that the
+    ///          driver allocates page-locked memory. Once mapped with
+    ///          MapBuffer(), it is a staging area from which WriteBuffer()
+    ///          and into which ReadBuffer() transfer at full speed.
+    ///
+    template<typename T>
+    cl_int AllocatePinnedBuffer(size_t Size, cl::Buffer & Buffer) {
+        INIT(Context);
+
+        assert(mDevices != 0);
+        assert(mContext != 0);
+
+        cl_int Error;
+        Buffer = cl::Buffer(*mContext, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, sizeof(T) * Size, 0, &Error);
+        if (Instrumentation::Enabled && Error == CL_SUCCESS) {
+            mCounters.BytesAllocated += sizeof(T) * Size;
+        }
+
+        return Error;
+    }
+
+    ///
+    /// \fn     AcquireBuffer
+    /// \tparam T      Type of the elements in the buffer
+    /// \param  Size   Number of elements in the buffer
+    /// \param  Buffer Output buffer that will be acquired
+    /// \return Any of the cl::Buffer error code
+    /// \brief  Acquires a buffer on the target device from the buffer pool
+    /// \details A buffer of the same size released with ReleaseBuffer() is
+    ///          reused if any, with its previous content. Otherwise, one is
+    ///          allocated.
+    ///
+    template<typename T>
+    cl_int AcquireBuffer(size_t Size, cl::Buffer & Buffer) {
+        INIT(Context);
+
+        assert(mDevices != 0);
+        assert(mContext != 0);
+
+        return GetBufferPool().Acquire(*mContext, CL_MEM_READ_WRITE, sizeof(T) * Size, Buffer);
+    }
+
+    ///
+    /// \fn     ReleaseBuffer
+    /// \param  Buffer Buffer to give back to the buffer pool
+    /// \return Any of the cl::Memory::getInfo error code
+    /// \brief  Gives a buffer back to the buffer pool, for reuse by AcquireBuffer()
+    /// \warning The buffer must not be used anymore by the caller
+    ///
+    cl_int ReleaseBuffer(const cl::Buffer & Buffer) {
+        return GetBufferPool().Release(Buffer);
+    }
+
     ///
     /// \fn      GetGridSize
     /// \param   LocalSize  Number of work-items per work-group
@@ -331,6 +1356,121 @@ public:
        GlobalSize = cl::NDRange(Size);
     }
 
+    ///
+    /// \fn      GetDevicePeaks
+    /// \param   Peaks Peak figures of the used device
+    /// \return  Any of the OpenCL cl::Device::getInfo error code and CL_OUT_OF_HOST_MEMORY
+    /// \brief   This function returns the peak figures the device is compared to
+    /// \details Unless they were set with SetDevicePeaks(), they are estimated
+    ///          from the device properties.
+    ///
+    cl_int GetDevicePeaks(DevicePeaks & Peaks) {
+        INIT(Peaks);
+
+        assert(mPeaks != 0);
+
+        Peaks = *mPeaks;
+
+        return CL_SUCCESS;
+    }
+
+    ///
+    /// \fn      SetDevicePeaks
+    /// \param   Peaks Peak figures of the used device
+    /// \return  CL_SUCCESS, CL_OUT_OF_HOST_MEMORY
+    /// \brief   This function overrides the peak figures the device is compared to
+    /// \details This allows using measured figures instead of the estimated ones.
+    ///
+    cl_int SetDevicePeaks(const DevicePeaks & Peaks) {
+        if (mPeaks == 0) {
+            mPeaks = new (std::nothrow) DevicePeaks;
+            if (mPeaks == 0) {
+                return CL_OUT_OF_HOST_MEMORY;
+            }
+        }
+
+        *mPeaks = Peaks;
+
+        return CL_SUCCESS;
+    }
+
+    ///
+    /// \fn      GetDeviceInfo
+    /// \param   Info Properties of the used device
+    /// \return  CL_SUCCESS, CL_OUT_OF_HOST_MEMORY, CL_DEVICE_NOT_FOUND
+    /// \brief   This function returns the properties of the used device
+    /// \details Properties come from the DeviceRegistry, so that no query is
+    ///          issued to the driver.
+    ///
+    cl_int GetDeviceInfo(DeviceInfo & Info) {
+        INIT(Devices);
+
+        assert(mDevices != 0);
+
+        return DeviceRegistry::Get().GetDeviceInfo(mDevices->at(mDevice), Info);
+    }
+
+    ///
+    /// \fn      GetDeviceProfile
+    /// \param   Profile Measured profile of the used device
+    /// \return  CL_SUCCESS, CL_OUT_OF_HOST_MEMORY, CL_DEVICE_NOT_FOUND, CL_INVALID_VALUE
+    /// \brief   This function returns the measured profile of the used device
+    /// \details CL_INVALID_VALUE is returned if no profile of the device was
+    ///          loaded with the DeviceProfiles option.
+    ///
+    cl_int GetDeviceProfile(DeviceProfile & Profile) {
+        INIT(Devices);
+
+        assert(mDevices != 0);
+
+        const DeviceProfile * Found = FindDeviceProfile(mProfiles,
+                                                        mDevices->at(mDevice).getInfo<CL_DEVICE_NAME>());
+        if (Found == 0) {
+            return CL_INVALID_VALUE;
+        }
+
+        Profile = *Found;
+
+        return CL_SUCCESS;
+    }
+
+    ///
+    /// \fn      GetContextDevices
+    /// \param   Devices Devices that are in the context
+    /// \return  CL_SUCCESS, CL_OUT_OF_HOST_MEMORY, CL_DEVICE_NOT_FOUND
+    /// \brief   Return all the devices programs are built for
+    /// \details The indices of the devices match the ones reported by
+    ///          GetKernelPlacements().
+    ///
+    cl_int GetContextDevices(std::vector<cl::Device> & Devices) {
+        INIT(Devices);
+
+        assert(mDevices != 0);
+
+        Devices = *mDevices;
+
+        return CL_SUCCESS;
+    }
+
+    ///
+    /// \fn      GetKernelPlacements
+    /// \param   Placements Placement state of all the kernels launched so far
+    /// \return  CL_SUCCESS, CL_INVALID_OPERATION
+    /// \brief   This function returns where each kernel runs and how fast
+    /// \details CL_INVALID_OPERATION is returned if kernels aren't placed,
+    ///          that is the DevicePlacement option isn't set or the context
+    ///          has a single device.
+    ///
+    cl_int GetKernelPlacements(std::vector<KernelPlacement> & Placements) {
+        if (mPlacementQueues.empty()) {
+            return CL_INVALID_OPERATION;
+        }
+
+        mPlacer.GetPlacements(Placements);
+
+        return CL_SUCCESS;
+    }
+
     ///
     /// \fn      GetUsedDevice
     /// \param   UsedDevice Device that will be used
@@ -350,6 +1490,55 @@ public:
         return CL_SUCCESS;
     }
 
+    ///
+    /// \fn      SetDeviceScorer
+    /// \param   Scorer Function scoring the devices
+    /// \return  CL_SUCCESS, CL_INVALID_OPERATION, CL_INVALID_VALUE
+    /// \brief   Replace the function used to score the devices
+    /// \details With SelectionByScore, the device with the highest score is
+    ///          selected, see the DeviceSelection option. The scorer gets the
+    ///          measured profile of the device if one was loaded with the
+    ///          DeviceProfiles option. The default scorer is
+    ///          GetDefaultDeviceScore().
+    /// \warning The scorer can only be set if no device was selected
+    ///
+    cl_int SetDeviceScorer(const DeviceScorer & Scorer) {
+        if (!Scorer) {
+            return CL_INVALID_VALUE;
+        }
+
+        if (mDevices != 0) {
+            return CL_INVALID_OPERATION;
+        }
+
+        mScorer = Scorer;
+
+        return CL_SUCCESS;
+    }
+
+    ///
+    /// \fn      SetUsedDevice
+    /// \param   Device Device to use
+    /// \return  CL_SUCCESS, CL_OUT_OF_HOST_MEMORY, CL_INVALID_OPERATION
+    /// \brief   Select the device that will be used by OpenCL for computation
+    /// \details This bypasses the search for a suitable device, which allows
+    ///          running on each device in turn, for instance.
+    /// \warning The device can only be set if no device was selected
+    ///
+    cl_int SetUsedDevice(const cl::Device & Device) {
+        if (mDevices != 0) {
+            return CL_INVALID_OPERATION;
+        }
+
+        mDevices = new (std::nothrow) std::vector<cl::Device>(1, Device);
+        if (mDevices == 0) {
+            return CL_OUT_OF_HOST_MEMORY;
+        }
+        mDevice = 0;
+
+        return CL_SUCCESS;
+    }
+
     ///
     /// \fn      GetProgramFromFile
     /// \param   FileName File containing the source to build
@@ -408,7 +1597,11 @@ public:
     /// \brief   This function builds the provided source code into a program
     /// \details This function will use any build option that may have been provided
     ///          with the SetParameter() with option BuildOptions. It will
-    ///          initialize a context first if required.
+    ///          initialize a context first if required. If the same source was
+    ///          already built with the same options, the cached program is
+    ///          returned along with its build log, unless disabled with the
+    ///          ProgramCaching option. In case of failure, the build log can
+    ///          be retrieved with GetLastBuildLog().
     ///
     cl_int GetProgramFromSource(const char * Source, size_t Length,
                                 cl::Program & Program) {
@@ -417,17 +1610,74 @@ public:
         assert(mDevices != 0);
         assert(mContext != 0);
 
+        std::string Key;
+        if (mProgramCaching) {
+            Key = ProgramCache::GetKey(Source, Length, mBuildOptions);
+            if (GetProgramCache().Find(Key, Program, mBuildLog)) {
+                RecordBuild(Length, true, 0, 0, 0, CL_SUCCESS);
+                return CL_SUCCESS;
+            }
+        }
+
+        cl_ulong CreateBegin = (Instrumentation::Enabled ? GetHostTime() : 0);
+
         cl_int Error;
         cl::Program::Sources Sources(1, std::make_pair(Source, Length + 1));
         Program = cl::Program(*mContext, Sources, &Error);
+        cl_ulong BuildBegin = (Instrumentation::Enabled ? GetHostTime() : 0);
         if (Error !=  CL_SUCCESS) {
+            mBuildLog.clear();
+            RecordBuild(Length, false, CreateBegin, BuildBegin, BuildBegin, Error);
             return Error;
         }
 
         Error = Program.build(*mDevices, (mBuildOptions.empty() ? 0 : mBuildOptions.c_str()));
+        cl_ulong BuildEnd = (Instrumentation::Enabled ? GetHostTime() : 0);
+
+        UpdateBuildLog(Program);
+        RecordBuild(Length, false, CreateBegin, BuildBegin, BuildEnd, Error);
+
+        if (Error == CL_SUCCESS && mProgramCaching) {
+            GetProgramCache().Insert(Key, Program, mBuildLog);
+        }
+
         return Error;
     }
 
+    ///
+    /// \fn      GetLastBuildLog
+    /// \param   Log Build log of the last built program
+    /// \return  CL_SUCCESS
+    /// \brief   This function returns the build log of the last built program
+    /// \details The log contains the errors and warnings reported by the
+    ///          compiler. It is empty if the compiler didn't report anything.
+    ///
+    cl_int GetLastBuildLog(std::string & Log) const {
+        Log = mBuildLog;
+        return CL_SUCCESS;
+    }
+
+    ///
+    /// \fn      GetBuildRecords
+    /// \param   Builds Telemetry of the last program builds, oldest first
+    /// \return  CL_SUCCESS
+    /// \brief   This function returns the telemetry of the last program builds
+    /// \details Each build reports its creation and build wall times, source
+    ///          size, options, device, cache status and build log.
+    ///
+    cl_int GetBuildRecords(std::vector<BuildRecord> & Builds) const {
+        mRecorder.GetBuildRecords(Builds);
+        return CL_SUCCESS;
+    }
+
+    ///
+    /// \fn      ClearProgramCache
+    /// \brief   This function drops all the cached programs
+    ///
+    void ClearProgramCache() {
+        GetProgramCache().Clear();
+    }
+
     ///
     /// \fn      GetKernelFromFile
     /// \param   FileName   File containing the source with the kernel
@@ -485,82 +1735,582 @@ public:
     ///          then return the matching kernel.
     /// \see     GetProgramFromSource()
     ///
-    cl_int GetKernelFromSource(const std::string & Source,
-                               const char * KernelName, cl::Kernel & Kernel) {
-        cl::Program Program;
-        cl_int Error = GetProgramFromSource(Source, Program);
-        if (Error !=  CL_SUCCESS) {
+    cl_int GetKernelFromSource(const std::string & Source,
+                               const char * KernelName, cl::Kernel & Kernel) {
+        cl::Program Program;
+        cl_int Error = GetProgramFromSource(Source, Program);
+        if (Error !=  CL_SUCCESS) {
+            return Error;
+        }
+
+        return GetKernelFromProgram(Program, KernelName, Kernel);
+    }
+
+    ///
+    /// \fn      GetKernelFromSource
+    /// \param   Source     Program source code that contains the kernel
+    /// \param   Length     Length of the program source code
+    /// \param   KernelName The name of the kernel
+    /// \param   Kernel     The matching kernel
+    /// \return  Any of the OpenCL error of cl::Kernel, cl::Program and cl::Program::build
+    /// \brief   This function returns a matching kernel from a source code
+    /// \details This function will first build the provided source code and will
+    ///          then return the matching kernel.
+    /// \see     GetProgramFromSource()
+    ///
+    cl_int GetKernelFromSource(const char * Source, size_t Length,
+                               const char * KernelName, cl::Kernel & Kernel) {
+        cl::Program Program;
+        cl_int Error = GetProgramFromSource(Source, Length, Program);
+        if (Error !=  CL_SUCCESS) {
+            return Error;
+        }
+
+        return GetKernelFromProgram(Program, KernelName, Kernel);
+    }
+
+    ///
+    /// \fn     GetKernelFromProgram
+    /// \param  Program    The program that contains the kernel
+    /// \param  KernelName The name of the kernel
+    /// \param  Kernel     The matching kernel
+    /// \return Any of the OpenCL error of cl::Kernel
+    /// \brief  This function returns a matching kernel from a program
+    ///
+    cl_int GetKernelFromProgram(const cl::Program & Program,
+                                const char * KernelName, cl::Kernel & Kernel) {
+        cl_int Error;
+        Kernel = cl::Kernel(Program, KernelName, &Error);
+        return Error;
+    }
+
+    ///
+    /// \fn      GetKernelResources
+    /// \param   Kernel    The kernel to inspect
+    /// \param   Resources The resources used by the kernel on the used device
+    /// \return  Any of the OpenCL error of cl::Kernel::getWorkGroupInfo
+    /// \brief   This function returns the resources used by a kernel
+    /// \details It will look for devices first if required.
+    ///
+    cl_int GetKernelResources(const cl::Kernel & Kernel, KernelResources & Resources) {
+        INIT(Devices);
+
+        assert(mDevices != 0);
+
+        cl_int Error;
+        const cl::Device & Device = mDevices->at(mDevice);
+        Resources.WorkGroupSize = Kernel.getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(Device, &Error);
+        if (Error != CL_SUCCESS) {
+            return Error;
+        }
+
+        Resources.LocalMemSize = Kernel.getWorkGroupInfo<CL_KERNEL_LOCAL_MEM_SIZE>(Device, &Error);
+        if (Error != CL_SUCCESS) {
+            return Error;
+        }
+
+        Resources.PrivateMemSize = Kernel.getWorkGroupInfo<CL_KERNEL_PRIVATE_MEM_SIZE>(Device, &Error);
+        if (Error != CL_SUCCESS) {
+            return Error;
+        }
+
+        Resources.PreferredMultiple = Kernel.getWorkGroupInfo<CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE>(Device, &Error);
+        return Error;
+    }
+
+    ///
+    /// \fn      GetKernelOccupancy
+    /// \param   Kernel   The kernel to inspect
+    /// \param   DataSize Size of data on which the kernel would work
+    /// \param   Report   Estimation of how well the launch uses the device
+    /// \return  Any of the OpenCL error of cl::Kernel::getWorkGroupInfo and cl::Device::getInfo
+    /// \brief   This function estimates how well a launch would use the device
+    /// \details The launch geometry is the one GetGridSize() would choose for
+    ///          DataSize. The occupancy combines the ratio of SIMD lanes doing
+    ///          work in each work-group, based on the preferred work-group
+    ///          size multiple, with the ratio of compute units that get at
+    ///          least one work-group. Sizes are the products of the
+    ///          dimensions of the ranges, up to the dimensions of the global
+    ///          range as the launch ignores the other ones. Flags report the
+    ///          issues found.
+    ///
+    cl_int GetKernelOccupancy(const cl::Kernel & Kernel, long DataSize,
+                              OccupancyReport & Report) {
+        cl_int Error = GetKernelResources(Kernel, Report.Resources);
+        if (Error != CL_SUCCESS) {
+            return Error;
+        }
+
+        const cl::Device & Device = mDevices->at(mDevice);
+        Report.ComputeUnits = Device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>(&Error);
+        if (Error != CL_SUCCESS) {
+            return Error;
+        }
+
+        Report.DeviceLocalMemSize = Device.getInfo<CL_DEVICE_LOCAL_MEM_SIZE>(&Error);
+        if (Error != CL_SUCCESS) {
+            return Error;
+        }
+
+        cl::NDRange GlobalSize, LocalSize;
+        GetGridSize(LocalSize, GlobalSize, DataSize);
+
+        const KernelResources & Resources = Report.Resources;
+        size_t Multiple = std::max(Resources.PreferredMultiple, static_cast<size_t>(1));
+        Report.GlobalSize = 1;
+        for (cl_uint i = 0; i < GlobalSize.dimensions(); i++) {
+            Report.GlobalSize *= GlobalSize[i];
+        }
+
+        Report.LocalSize = 1;
+        for (cl_uint i = 0; i < LocalSize.dimensions() && i < GlobalSize.dimensions(); i++) {
+            Report.LocalSize *= LocalSize[i];
+        }
+        Report.LocalSize = std::max(Report.LocalSize, static_cast<size_t>(1));
+        Report.Groups = (Report.GlobalSize + Report.LocalSize - 1) / Report.LocalSize;
+        Report.LaneEfficiency = static_cast<double>(Report.LocalSize) /
+                                (((Report.LocalSize + Multiple - 1) / Multiple) * Multiple);
+        Report.UnitCoverage = (Report.ComputeUnits == 0 ? 0.0 :
+                               std::min(1.0, static_cast<double>(Report.Groups) / Report.ComputeUnits));
+        Report.Occupancy = Report.LaneEfficiency * Report.UnitCoverage;
+
+        Report.Flags = 0;
+        if (LocalSize.dimensions() != 0 && LocalSize.dimensions() != GlobalSize.dimensions()) {
+            Report.Flags |= MismatchedRanges;
+        }
+
+        if (Report.LocalSize > Resources.WorkGroupSize) {
+            Report.Flags |= GroupTooLarge;
+        }
+
+        if (Report.Groups < Report.ComputeUnits) {
+            Report.Flags |= FewGroups;
+        }
+
+        if (Report.LocalSize < Multiple) {
+            Report.Flags |= SmallGroups;
+        } else if (Report.LocalSize % Multiple != 0) {
+            Report.Flags |= PartialGroups;
+        }
+
+        if (Resources.LocalMemSize != 0 &&
+            Resources.LocalMemSize * 2 > Report.DeviceLocalMemSize) {
+            Report.Flags |= LocalMemoryBound;
+        }
+
+        return CL_SUCCESS;
+    }
+
+    ///
+    /// \fn      GetLastElapsedTime
+    /// \param   ElapsedTime The elapsed time of the last event in ns
+    /// \return  Any of the OpenCL error of cl::Event::getProfilingInfo
+    /// \brief   This function returns the elapsed time of the last event
+    /// \details Elasped time is taken into account between the start of the
+    ///          command and its end.
+    /// \see     GetLastElapsedTime()
+    ///
+    cl_int GetLastElapsedTime(double * ElapsedTime) {
+        cl_ulong Elapsed;
+
+        cl_int Error = GetLastElapsedTime(&Elapsed);
+        if (Error != CL_SUCCESS) {
+            return Error;
+        }
+
+        *ElapsedTime = static_cast<double>(Elapsed);
+
+        return CL_SUCCESS;
+    }
+
+    ///
+    /// \fn      GetLastElapsedTime
+    /// \param   ElapsedTime The exact elapsed time of the last event in ns
+    /// \return  Any of the OpenCL error of cl::Event::getProfilingInfo
+    /// \brief   This function returns the elapsed time of the last event
+    /// \details Elasped time is taken into account between the start of the
+    ///          command and its end. Timestamps are read as cl_ulong, as
+    ///          returned by OpenCL, so no precision is lost. Timestamps are
+    ///          only available if the last command was profiled.
+    /// \see     ProfilingModes
+    ///
+    cl_int GetLastElapsedTime(cl_ulong * ElapsedTime) {
+        cl_int Error;
+        cl_ulong Start, End;
+
+        Error = mEvent.getProfilingInfo(CL_PROFILING_COMMAND_START, &Start);
+        if (Error != CL_SUCCESS) {
+            return Error;
+        }
+
+        Error = mEvent.getProfilingInfo(CL_PROFILING_COMMAND_END, &End);
+        if (Error != CL_SUCCESS) {
+            return Error;
+        }
+
+        *ElapsedTime = GetElapsed(Start, End);
+
+        return CL_SUCCESS;
+    }
+
+    ///
+    /// \fn      GetLastLatencyBreakdown
+    /// \param   Breakdown Decomposition of the latency of the last command
+    /// \return  Any of the OpenCL error of cl::Event::getProfilingInfo
+    /// \brief   This function decomposes the latency of the last command
+    /// \details The latency is split between the time spent in the host API
+    ///          call, the wait in the queue (SUBMIT - QUEUED), the launch
+    ///          latency (START - SUBMIT) and the execution (END - START), all
+    ///          in exact ns. The caller will be blocked until the command is
+    ///          done.
+    ///
+    cl_int GetLastLatencyBreakdown(LatencyBreakdown & Breakdown) {
+        CommandRecord Record;
+        cl_int Error = mRecorder.GetLastRecord(Record);
+        if (Error != CL_SUCCESS) {
+            return Error;
+        }
+
+        return GetLatencyBreakdown(Record, Breakdown);
+    }
+
+    ///
+    /// \fn      GetCommandRecords
+    /// \param   Records Profiling information of the last queued commands
+    /// \return  Any of the OpenCL error of cl::Event::getProfilingInfo
+    /// \brief   This function returns the timeline of the last queued commands
+    /// \details Contrary to GetLastElapsedTime(), all the commands queued since
+    ///          the last call to ClearCommandRecords() are returned, up to the
+    ///          amount set with the RecordedCommands parameter. The caller
+    ///          will be blocked until all those commands are done.
+    ///
+    cl_int GetCommandRecords(std::vector<CommandRecord> & Records) {
+        return mRecorder.GetRecords(Records);
+    }
+
+    ///
+    /// \fn      ExportChromeTrace
+    /// \param   Stream The stream in which the trace is written
+    /// \return  CL_SUCCESS, CL_INVALID_VALUE
+    /// \brief   This function exports the timeline of the last queued commands
+    /// \details The timeline is written as Chrome trace event JSON that can be
+    ///          opened with Perfetto. Host API calls and device executions are
+    ///          on separate tracks, so that transfer/compute overlap and idle
+    ///          gaps are visible. The caller will be blocked until all the
+    ///          recorded commands are done.
+    /// \see     GetCommandRecords()
+    ///
+    cl_int ExportChromeTrace(std::ostream & Stream) {
+        return mRecorder.ExportChromeTrace(Stream);
+    }
+
+    ///
+    /// \fn      ExportChromeTrace
+    /// \param   FileName File in which the trace is written
+    /// \return  CL_SUCCESS, CL_INVALID_VALUE
+    /// \brief   This function exports the timeline of the last queued commands
+    /// \see     ExportChromeTrace()
+    ///
+    cl_int ExportChromeTrace(const char * FileName) {
+        std::ofstream Trace(FileName);
+        if (!Trace.is_open()) {
+            return CL_INVALID_VALUE;
+        }
+
+        return ExportChromeTrace(Trace);
+    }
+
+    ///
+    /// \fn      ExportMetrics
+    /// \param   Stream The stream in which the metrics are written
+    /// \return  CL_SUCCESS, CL_INVALID_VALUE, CL_INVALID_OPERATION
+    /// \brief   This function exports the wrapper counters as Prometheus metrics
+    /// \details Metrics are written in the Prometheus text exposition format:
+    ///          kernel launches, bytes transferred and allocated, program cache
+    ///          hits and misses, queue depth and latency histograms per kernel
+    ///          and transfer direction. The queue depth only accounts for the
+    ///          profiled commands. Exporting never waits for the device: the
+    ///          histograms only account for the commands done so far. All the
+    ///          metrics are labeled with the device name. CL_INVALID_OPERATION
+    ///          is returned if instrumentation is disabled.
+    ///
+    cl_int ExportMetrics(std::ostream & Stream) {
+        if (!Instrumentation::Enabled) {
+            return CL_INVALID_OPERATION;
+        }
+
+        std::string Device;
+        if (mDevices != 0) {
+            Device = "device=\"" + EscapeLabel(mDevices->at(mDevice).getInfo<CL_DEVICE_NAME>()) + "\"";
+        } else {
+            Device = "device=\"\"";
+        }
+
+        //
+        // The depth is taken before the done commands are resolved
+        //
+        cl_ulong Depth = mRecorder.GetPendingCommands();
+        std::vector<OperationStatistics> Statistics;
+        mRecorder.GetCompletedStatistics(Statistics);
+
+        std::ostringstream Metrics;
+        Metrics << "# HELP opencl_wrapper_kernel_launches_total Number of kernels launched.\n"
+                << "# TYPE opencl_wrapper_kernel_launches_total counter\n"
+                << "opencl_wrapper_kernel_launches_total{" << Device << "} "
+                << mCounters.KernelLaunches << "\n"
+                << "# HELP opencl_wrapper_bytes_transferred_total Number of bytes transferred between host and device.\n"
+                << "# TYPE opencl_wrapper_bytes_transferred_total counter\n"
+                << "opencl_wrapper_bytes_transferred_total{" << Device << ",direction=\"read\"} "
+                << mCounters.BytesRead << "\n"
+                << "opencl_wrapper_bytes_transferred_total{" << Device << ",direction=\"write\"} "
+                << mCounters.BytesWritten << "\n"
+                << "# HELP opencl_wrapper_bytes_allocated_total Number of bytes allocated for device buffers.\n"
+                << "# TYPE opencl_wrapper_bytes_allocated_total counter\n"
+                << "opencl_wrapper_bytes_allocated_total{" << Device << "} "
+                << mCounters.BytesAllocated << "\n"
+                << "# HELP opencl_wrapper_program_cache_hits_total Number of programs found in the cache.\n"
+                << "# TYPE opencl_wrapper_program_cache_hits_total counter\n"
+                << "opencl_wrapper_program_cache_hits_total{" << Device << "} "
+                << GetProgramCache().GetHits() << "\n"
+                << "# HELP opencl_wrapper_program_cache_misses_total Number of programs that had to be built.\n"
+                << "# TYPE opencl_wrapper_program_cache_misses_total counter\n"
+                << "opencl_wrapper_program_cache_misses_total{" << Device << "} "
+                << GetProgramCache().GetMisses() << "\n"
+                << "# HELP opencl_wrapper_buffer_pool_hits_total Number of buffers reused from the pool.\n"
+                << "# TYPE opencl_wrapper_buffer_pool_hits_total counter\n"
+                << "opencl_wrapper_buffer_pool_hits_total{" << Device << "} "
+                << GetBufferPool().GetHits() << "\n"
+                << "# HELP opencl_wrapper_buffer_pool_misses_total Number of buffers the pool had to allocate.\n"
+                << "# TYPE opencl_wrapper_buffer_pool_misses_total counter\n"
+                << "opencl_wrapper_buffer_pool_misses_total{" << Device << "} "
+                << GetBufferPool().GetMisses() << "\n"
+                << "# HELP opencl_wrapper_buffer_pool_bytes Number of bytes of the buffers kept in the pool.\n"
+                << "# TYPE opencl_wrapper_buffer_pool_bytes gauge\n"
+                << "opencl_wrapper_buffer_pool_bytes{" << Device << "} "
+                << GetBufferPool().GetPooledBytes() << "\n"
+                << "# HELP opencl_wrapper_queue_depth Number of profiled commands not done yet.\n"
+                << "# TYPE opencl_wrapper_queue_depth gauge\n"
+                << "opencl_wrapper_queue_depth{" << Device << "} "
+                << Depth << "\n"
+                << "# HELP opencl_wrapper_dropped_commands_total Number of profiled commands dropped before being done.\n"
+                << "# TYPE opencl_wrapper_dropped_commands_total counter\n"
+                << "opencl_wrapper_dropped_commands_total{" << Device << "} "
+                << mRecorder.GetDroppedCommands() << "\n";
+
+        static const char * Types[MaxCommands] = { "kernel", "read", "write" };
+        Metrics << "# HELP opencl_wrapper_command_duration_seconds Device execution time of the profiled commands.\n"
+                << "# TYPE opencl_wrapper_command_duration_seconds histogram\n";
+        for (size_t i = 0; i < Statistics.size(); i++) {
+            WritePrometheusHistogram(Metrics, "opencl_wrapper_command_duration_seconds",
+                                     Device + ",type=\"" + Types[Statistics[i].Type] +
+                                     "\",name=\"" + EscapeLabel(Statistics[i].Name) + "\"",
+                                     Statistics[i].DeviceHistogram);
+        }
+
+        Metrics << "# HELP opencl_wrapper_command_host_overhead_seconds Host time spent queuing the profiled commands.\n"
+                << "# TYPE opencl_wrapper_command_host_overhead_seconds histogram\n";
+        for (size_t i = 0; i < Statistics.size(); i++) {
+            WritePrometheusHistogram(Metrics, "opencl_wrapper_command_host_overhead_seconds",
+                                     Device + ",type=\"" + Types[Statistics[i].Type] +
+                                     "\",name=\"" + EscapeLabel(Statistics[i].Name) + "\"",
+                                     Statistics[i].HostHistogram);
+        }
+
+        Stream << Metrics.str();
+
+        return (Stream.good() ? CL_SUCCESS : CL_INVALID_VALUE);
+    }
+
+    ///
+    /// \fn      ExportMetrics
+    /// \param   FileName File in which the metrics are written
+    /// \return  CL_SUCCESS, CL_INVALID_VALUE, CL_INVALID_OPERATION
+    /// \brief   This function exports the wrapper counters as Prometheus metrics
+    /// \details The metrics are first written to a temporary file which is then
+    ///          renamed, so that a textfile collector never reads a partial file.
+    /// \see     ExportMetrics()
+    ///
+    cl_int ExportMetrics(const char * FileName) {
+        std::string Temporary = std::string(FileName) + ".tmp";
+        std::ofstream Metrics(Temporary.c_str());
+        if (!Metrics.is_open()) {
+            return CL_INVALID_VALUE;
+        }
+
+        cl_int Error = ExportMetrics(Metrics);
+        Metrics.close();
+        if (Error != CL_SUCCESS || Metrics.fail()) {
+            std::remove(Temporary.c_str());
+            return (Error != CL_SUCCESS ? Error : CL_INVALID_VALUE);
+        }
+
+        if (std::rename(Temporary.c_str(), FileName) != 0) {
+            std::remove(Temporary.c_str());
+            return CL_INVALID_VALUE;
+        }
+
+        return CL_SUCCESS;
+    }
+
+    ///
+    /// \fn      GetLastThroughput
+    /// \param   Report Throughput achieved by the last command
+    /// \return  Any of the OpenCL error of cl::Event::getProfilingInfo and cl::Device::getInfo
+    /// \brief   This function returns the throughput achieved by the last command
+    /// \details Reads and writes report the achieved bandwidth. Kernels report
+    ///          the achieved GFLOP/s and effective bandwidth if their workload
+    ///          was declared. Both are compared to the device peaks.
+    /// \see     GetDevicePeaks()
+    ///
+    cl_int GetLastThroughput(ThroughputReport & Report) {
+        INIT(Peaks);
+
+        assert(mPeaks != 0);
+
+        CommandRecord Record;
+        cl_int Error = mRecorder.GetLastRecord(Record);
+        if (Error != CL_SUCCESS) {
             return Error;
         }
 
-        return GetKernelFromProgram(Program, KernelName, Kernel);
+        return GetThroughput(Record, *mPeaks, Report);
     }
 
     ///
-    /// \fn      GetKernelFromSource
-    /// \param   Source     Program source code that contains the kernel
-    /// \param   Length     Length of the program source code
-    /// \param   KernelName The name of the kernel
-    /// \param   Kernel     The matching kernel
-    /// \return  Any of the OpenCL error of cl::Kernel, cl::Program and cl::Program::build
-    /// \brief   This function returns a matching kernel from a source code
-    /// \details This function will first build the provided source code and will
-    ///          then return the matching kernel.
-    /// \see     GetProgramFromSource()
+    /// \fn      GetThroughputs
+    /// \param   Reports Throughput achieved by the last queued commands
+    /// \return  Any of the OpenCL error of cl::Device::getInfo
+    /// \brief   This function returns the throughput achieved by the last commands
+    /// \details Commands whose timestamps couldn't be queried are skipped.
+    /// \see     GetLastThroughput()
     ///
-    cl_int GetKernelFromSource(const char * Source, size_t Length,
-                               const char * KernelName, cl::Kernel & Kernel) {
-        cl::Program Program;
-        cl_int Error = GetProgramFromSource(Source, Length, Program);
-        if (Error !=  CL_SUCCESS) {
-            return Error;
+    cl_int GetThroughputs(std::vector<ThroughputReport> & Reports) {
+        INIT(Peaks);
+
+        assert(mPeaks != 0);
+
+        std::vector<CommandRecord> Records;
+        mRecorder.GetRecords(Records);
+
+        Reports.clear();
+        for (size_t i = 0; i < Records.size(); i++) {
+            ThroughputReport Report;
+            if (GetThroughput(Records[i], *mPeaks, Report) == CL_SUCCESS) {
+                Reports.push_back(Report);
+            }
         }
 
-        return GetKernelFromProgram(Program, KernelName, Kernel);
+        return CL_SUCCESS;
     }
 
     ///
-    /// \fn     GetKernelFromProgram
-    /// \param  Program    The program that contains the kernel
-    /// \param  KernelName The name of the kernel
-    /// \param  Kernel     The matching kernel
-    /// \return Any of the OpenCL error of cl::Kernel
-    /// \brief  This function returns a matching kernel from a program
+    /// \fn      GetRoofline
+    /// \param   Points Position of each profiled kernel on the roofline
+    /// \return  Any of the OpenCL error of cl::Device::getInfo
+    /// \brief   This function places the profiled kernels on the device roofline
+    /// \details Kernels are placed from their declared workload or, if none
+    ///          was declared, from the bytes of their buffer arguments. The
+    ///          roof is given by the device peaks, that should come from a
+    ///          characterization run. The caller will be blocked until all
+    ///          the recorded commands are done.
+    /// \see     GetDevicePeaks(), DeviceProfiles
     ///
-    cl_int GetKernelFromProgram(const cl::Program & Program,
-                                const char * KernelName, cl::Kernel & Kernel) {
-        cl_int Error;
-        Kernel = cl::Kernel(Program, KernelName, &Error);
-        return Error;
+    cl_int GetRoofline(std::vector<RooflinePoint> & Points) {
+        INIT(Peaks);
+
+        assert(mPeaks != 0);
+
+        std::vector<OperationStatistics> Statistics;
+        mRecorder.GetStatistics(Statistics);
+
+        Points.clear();
+        for (size_t i = 0; i < Statistics.size(); i++) {
+            if (Statistics[i].Type != KernelCommand) {
+                continue;
+            }
+
+            RooflinePoint Point;
+            GetRooflinePoint(Statistics[i], *mPeaks, Point);
+            Points.push_back(Point);
+        }
+
+        return CL_SUCCESS;
     }
 
     ///
-    /// \fn      GetLastElapsedTime
-    /// \param   ElapsedTime The elapsed time of the last event in ns
-    /// \return  Any of the OpenCL error of cl::Event::getProfilingInfo
-    /// \brief   This function returns the elapsed time of the last event
-    /// \details Elasped time is taken into account between the start of the
-    ///          command and its end.
+    /// \fn      ExportRoofline
+    /// \param   Stream The stream in which the report is written
+    /// \param   Format Format of the report, see ReportFormats
+    /// \return  Any of the OpenCL error of cl::Device::getInfo, CL_INVALID_VALUE
+    /// \brief   This function writes the roofline report of the profiled kernels
+    /// \details For each kernel, the report shows its arithmetic intensity,
+    ///          its achieved GFLOP/s and GB/s, the attainable GFLOP/s at its
+    ///          intensity, how close it is to it and whether it is compute or
+    ///          bandwidth bound.
+    /// \see     GetRoofline()
     ///
-    cl_int GetLastElapsedTime(double * ElapsedTime) {
-        cl_int Error;
-        double Start, End;
+    cl_int ExportRoofline(std::ostream & Stream, unsigned int Format) {
+        std::vector<RooflinePoint> Points;
 
-        Error = mEvent.getProfilingInfo(CL_PROFILING_COMMAND_START, &Start);
+        cl_int Error = GetRoofline(Points);
         if (Error != CL_SUCCESS) {
             return Error;
         }
 
-        Error = mEvent.getProfilingInfo(CL_PROFILING_COMMAND_END, &End);
-        if (Error != CL_SUCCESS) {
-            return Error;
+        return WriteRooflineReport(Stream, Points, *mPeaks, Format);
+    }
+
+    ///
+    /// \fn      ExportRoofline
+    /// \param   FileName File in which the report is written
+    /// \param   Format   Format of the report, see ReportFormats
+    /// \return  Any of the OpenCL error of cl::Device::getInfo, CL_INVALID_VALUE
+    /// \brief   This function writes the roofline report of the profiled kernels
+    /// \see     ExportRoofline()
+    ///
+    cl_int ExportRoofline(const char * FileName, unsigned int Format) {
+        std::ofstream Report(FileName);
+        if (!Report.is_open()) {
+            return CL_INVALID_VALUE;
         }
 
-        *ElapsedTime = (End - Start);
+        return ExportRoofline(Report, Format);
+    }
 
+    ///
+    /// \fn      GetStatistics
+    /// \param   Statistics Aggregated statistics per kernel and transfer direction
+    /// \return  CL_SUCCESS
+    /// \brief   This function returns the latency statistics of the queued commands
+    /// \details Contrary to GetCommandRecords(), statistics account for all the
+    ///          commands queued since the last call to ResetStatistics(), and
+    ///          not only for the last ones. The caller will be blocked until all
+    ///          the recorded commands are done.
+    ///
+    cl_int GetStatistics(std::vector<OperationStatistics> & Statistics) {
+        mRecorder.GetStatistics(Statistics);
         return CL_SUCCESS;
     }
 
+    ///
+    /// \fn      ResetStatistics
+    /// \brief   This function drops the latency statistics of all the commands
+    ///
+    void ResetStatistics() {
+        mRecorder.ResetStatistics();
+    }
+
+    ///
+    /// \fn      ClearCommandRecords
+    /// \brief   This function drops the profiling information of all the commands
+    /// \details The caller isn't blocked. Commands already done are still
+    ///          accounted in the statistics, the other ones are counted as
+    ///          dropped, see ExportMetrics().
+    ///
+    void ClearCommandRecords() {
+        mRecorder.Clear();
+    }
+
     ///
     /// \fn      ExecuteKernelFromFile
     /// \tparam  Args       Types of the kernel arguments
@@ -710,6 +2460,117 @@ public:
         return ExecuteKernelFromKernelEx(intKernel, DataSize, 0, KernelArgs...);
     }
 
+    ///
+    /// \fn      ExecuteKernelFromKernel
+    /// \tparam  Args       Types of the kernel arguments
+    /// \param   Kernel     Kernel to execute
+    /// \param   DataSize   Size on which the kernel will work
+    /// \param   Workload   Operations and bytes done by this launch
+    /// \param   KernelArgs Arguments of the kernel
+    /// \return  Any error code of OpenCL
+    /// \brief   This function will execute a specific kernel from a program
+    /// \details The kernel will be executed on the target device with the given
+    ///          arguments. The declared workload is used to compute the
+    ///          GFLOP/s and effective bandwidth of the launch.
+    /// \see     GetLastThroughput()
+    ///
+    template<typename... Args>
+    cl_int ExecuteKernelFromKernel(const cl::Kernel & Kernel, long DataSize,
+                                   const KernelWorkload & Workload,
+                                   const Args&... KernelArgs) {
+        cl::Kernel intKernel = Kernel;
+        mWorkload = Workload;
+        return ExecuteKernelFromKernelEx(intKernel, DataSize, 0, KernelArgs...);
+    }
+
+    ///
+    /// \fn      ExecuteKernelOnRange
+    /// \tparam  Args       Types of the kernel arguments
+    /// \param   Kernel     Kernel to execute
+    /// \param   GlobalSize Number of work-items
+    /// \param   LocalSize  Number of work-items per work-group, cl::NullRange
+    ///                     lets OpenCL choose
+    /// \param   KernelArgs Arguments of the kernel
+    /// \return  Any error code of OpenCL
+    /// \brief   This function will execute a specific kernel on a given grid
+    /// \details Unlike ExecuteKernelFromKernel(), the grid size isn't derived
+    ///          from the data size, so that any number of dimensions and any
+    ///          work-group size can be used.
+    ///
+    template<typename... Args>
+    cl_int ExecuteKernelOnRange(const cl::Kernel & Kernel, const cl::NDRange & GlobalSize,
+                                const cl::NDRange & LocalSize, const Args&... KernelArgs) {
+        cl::Kernel intKernel = Kernel;
+        return ExecuteKernelOnRangeEx(intKernel, GlobalSize, LocalSize, 0, KernelArgs...);
+    }
+
+    ///
+    /// \fn     MapBuffer
+    /// \tparam T      Type of the buffer elements
+    /// \param  Buffer The buffer to map
+    /// \param  Flags  CL_MAP_READ, CL_MAP_WRITE or CL_MAP_WRITE_INVALIDATE_REGION
+    /// \param  Size   Number of elements to map
+    /// \param  Host   Host pointer on the mapped elements
+    /// \return Any OpenCL error code from cl::Queue::enqueueMapBuffer
+    /// \brief  The function will map a buffer into the host address space
+    /// \details The caller will be blocked until the buffer is mapped. The
+    ///          buffer has to be unmapped with UnmapBuffer() before it is
+    ///          used by any other command. Maps go to the default queue and
+    ///          aren't profiled, so they don't change which commands are
+    ///          sampled.
+    ///
+    template<typename T>
+    cl_int MapBuffer(cl::Buffer & Buffer, cl_map_flags Flags, size_t Size, T *& Host) {
+        INIT(Queue);
+
+        assert(mDevices != 0);
+        assert(mContext != 0);
+        assert(mQueue != 0);
+
+        //
+        // Maps aren't recorded, so they don't count for sampling
+        //
+        cl::CommandQueue * Queue = mQueue;
+
+        cl_int Error;
+        void * Mapped = Queue->enqueueMapBuffer(Buffer, true, Flags, 0, sizeof(T) * Size,
+                                                GetWaitList(Queue), &mEvent, &Error);
+        if (Error == CL_SUCCESS) {
+            SetLastCommand(Queue);
+            Host = static_cast<T *>(Mapped);
+        }
+
+        return Error;
+    }
+
+    ///
+    /// \fn     UnmapBuffer
+    /// \param  Buffer The mapped buffer
+    /// \param  Host   Host pointer returned by MapBuffer()
+    /// \return Any OpenCL error code from cl::Queue::enqueueUnmapMemObject
+    /// \brief  The function will unmap a buffer mapped with MapBuffer()
+    /// \warning Host must not be used anymore by the caller
+    ///
+    cl_int UnmapBuffer(cl::Buffer & Buffer, void * Host) {
+        INIT(Queue);
+
+        assert(mDevices != 0);
+        assert(mContext != 0);
+        assert(mQueue != 0);
+
+        //
+        // Maps aren't recorded, so they don't count for sampling
+        //
+        cl::CommandQueue * Queue = mQueue;
+
+        cl_int Error = Queue->enqueueUnmapMemObject(Buffer, Host, GetWaitList(Queue), &mEvent);
+        if (Error == CL_SUCCESS) {
+            SetLastCommand(Queue);
+        }
+
+        return Error;
+    }
+
     ///
     /// \fn     ReadBuffer
     /// \tparam T      Type of the buffer elements
@@ -727,17 +2588,44 @@ public:
         assert(mContext != 0);
         assert(mQueue != 0);
 
-        return mQueue->enqueueReadBuffer(Buffer, true, 0, sizeof(T) * Size, Host,
-                                         0, &mEvent);
+        cl::CommandQueue * Queue;
+        bool Profiled = SelectQueue(Queue);
+
+        cl_ulong HostBegin = (Instrumentation::Enabled && Profiled ? GetHostTime() : 0);
+        cl_int Error = Queue->enqueueReadBuffer(Buffer, true, 0, sizeof(T) * Size,
+                                                Host, GetWaitList(Queue), &mEvent);
+        cl_ulong HostEnd = (Instrumentation::Enabled && Profiled ? GetHostTime() : 0);
+        if (Error == CL_SUCCESS) {
+            SetLastCommand(Queue);
+            if (Instrumentation::Enabled) {
+                mCounters.BytesRead += sizeof(T) * Size;
+            }
+
+            if (Instrumentation::Enabled && Profiled) {
+                mRecorder.Record(ReadCommand, "", sizeof(T) * Size, 0, cl::NullRange,
+                                 cl::NullRange, mEvent, mQueueIndex, HostBegin, HostEnd);
+            }
+        }
+
+        return Error;
     }
 
     ///
     /// \fn      SetParameter
     /// \param   Parameter The parameter to set
     /// \param   Value     The value of the parameter to set
-    /// \return  CL_SUCCESS, CL_INVALID_OPERATION
+    /// \return  CL_SUCCESS, CL_INVALID_OPERATION, CL_INVALID_VALUE
     /// \brief   This function tries to define a parameter with the given value
-    /// \warning TargetDevice parameter can only be set if no device was selected
+    /// \warning TargetDevice, DeviceSelection, DevicePlacement, DevicePartition
+    ///          and SubDevice parameters can only be set if no device was
+    ///          selected, ProfilingMode parameter can only be set if no
+    ///          queue was created and ConcurrentQueues parameter can only be
+    ///          set before the first EnqueueKernel(). NumaPolicy parameter
+    ///          can only be set to NumaOff if NUMA isn't available, see
+    ///          OPENCLWRAPPER_USE_NUMA. Attaching to a runtime selects its
+    ///          device, so DevicePartition can't be combined with
+    ///          AttachRuntime(), while DevicePlacement uses the devices of
+    ///          the runtime
     ///
     cl_int SetParameter(OpenCLParameters Parameter, unsigned long Value) {
         cl_int Error = CL_INVALID_OPERATION;
@@ -754,6 +2642,109 @@ public:
                 }
                 break;
 
+            case RecordedCommands:
+                Error = mRecorder.SetCapacity(Value);
+                break;
+
+            case ProfilingMode:
+                if (mQueue == 0) {
+                    if (Value < MaxProfilingModes) {
+                        mProfilingMode = Value;
+                        Error = CL_SUCCESS;
+                    } else {
+                        Error = CL_INVALID_VALUE;
+                    }
+                }
+                break;
+
+            case ProfilingSampling:
+                if (Value != 0) {
+                    mSampling = Value;
+                    Error = CL_SUCCESS;
+                } else {
+                    Error = CL_INVALID_VALUE;
+                }
+                break;
+
+            case ProgramCaching:
+                mProgramCaching = (Value != 0);
+                Error = CL_SUCCESS;
+                break;
+
+            case DeviceSelection:
+                if (mDevices == 0) {
+                    if (Value < MaxDeviceSelections) {
+                        mSelection = Value;
+                        Error = CL_SUCCESS;
+                    } else {
+                        Error = CL_INVALID_VALUE;
+                    }
+                }
+                break;
+
+            case DevicePlacement:
+                if (mDevices == 0) {
+                    mPlacement = (Value != 0);
+                    Error = CL_SUCCESS;
+                }
+                break;
+
+            case PlacementProbes:
+                Error = mPlacer.SetProbes(Value);
+                break;
+
+            case PlacementInterval:
+                mPlacer.SetInterval(Value);
+                Error = CL_SUCCESS;
+                break;
+
+            case DevicePartition:
+                if (mDevices == 0) {
+                    if (Value < MaxPartitionModes) {
+                        mPartition = Value;
+                        Error = CL_SUCCESS;
+                    } else {
+                        Error = CL_INVALID_VALUE;
+                    }
+                }
+                break;
+
+            case SubDevice:
+                if (mDevices == 0) {
+                    mSubDevice = Value;
+                    Error = CL_SUCCESS;
+                }
+                break;
+
+            case NumaPolicy:
+                if (Value >= MaxNumaPolicies) {
+                    Error = CL_INVALID_VALUE;
+                } else if (Value == NumaOff || IsNumaAvailable()) {
+                    mNumaPolicy = Value;
+                    Error = CL_SUCCESS;
+                }
+                break;
+
+            case ConcurrentQueues:
+                if (mConcurrentQueues.empty()) {
+                    if (Value != 0) {
+                        mConcurrency = Value;
+                        Error = CL_SUCCESS;
+                    } else {
+                        Error = CL_INVALID_VALUE;
+                    }
+                }
+                break;
+
+            case NumaNode:
+                if (Value <= static_cast<unsigned long>(INT_MAX)) {
+                    mNumaNode = static_cast<int>(Value);
+                    Error = CL_SUCCESS;
+                } else {
+                    Error = CL_INVALID_VALUE;
+                }
+                break;
+
             case MaxParameters:
             default:
                 break;
@@ -766,9 +2757,13 @@ public:
     /// \fn      SetParameter
     /// \param   Parameter The parameter to set
     /// \param   Value     The value of the parameter to set
-    /// \return  CL_SUCCESS, CL_INVALID_OPERATION
+    /// \return  CL_SUCCESS, CL_INVALID_OPERATION, CL_INVALID_VALUE
     /// \brief   This function tries to define a parameter with the given value
-    /// \warning TargetDevice parameter can only be set if no device was selected
+    /// \warning DeviceProfiles parameter can only be set if the peak figures
+    ///          weren't computed yet, and has to be set before a device is
+    ///          selected to be used for the selection. RequiredExtensions
+    ///          and PartitionCounts parameters can only be set if no device
+    ///          was selected
     ///
     cl_int SetParameter(OpenCLParameters Parameter, std::string & Value) {
         cl_int Error = CL_INVALID_OPERATION;
@@ -779,6 +2774,40 @@ public:
                 Error = CL_SUCCESS;
                 break;
 
+            case RequiredExtensions:
+                if (mDevices == 0) {
+                    mRequiredExtensions = Value;
+                    Error = CL_SUCCESS;
+                }
+                break;
+
+            case PartitionCounts:
+                if (mDevices == 0) {
+                    std::istringstream Stream(Value);
+                    std::vector<cl_uint> Counts;
+                    cl_uint Count;
+
+                    while (Stream >> Count) {
+                        Counts.push_back(Count);
+                    }
+
+                    if (Stream.eof() && !Counts.empty()) {
+                        mPartitionCounts = Counts;
+                        Error = CL_SUCCESS;
+                    } else {
+                        Error = CL_INVALID_VALUE;
+                    }
+                }
+                break;
+
+            case DeviceProfiles:
+                if (mPeaks == 0) {
+                    std::ifstream File(Value.c_str());
+                    Error = (File.is_open() ? LoadDeviceProfiles(File, mProfiles) :
+                                              CL_INVALID_VALUE);
+                }
+                break;
+
             case MaxParameters:
             default:
                 break;
@@ -787,6 +2816,117 @@ public:
         return Error;
     }
 
+    ///
+    /// \fn      EnqueueKernel
+    /// \param   Kernel     Kernel to execute, with its arguments set
+    /// \param   GlobalSize Number of work-items
+    /// \param   LocalSize  Number of work-items per work-group, cl::NullRange
+    ///                     lets OpenCL choose
+    /// \param   WaitList   Events the kernel has to wait for
+    /// \param   Done       Event of the kernel
+    /// \return  Any error code of OpenCL
+    /// \brief   This function queues a kernel that only waits for the given events
+    /// \details Unlike ExecuteKernelOnRange(), the kernel isn't ordered with
+    ///          the other kernels queued by this function, so that
+    ///          independent kernels overlap. It still waits for the last
+    ///          command queued by the other functions, and these wait for all
+    ///          the kernels queued by this function before them. Kernels go
+    ///          to an out of order queue if the device supports it, or to
+    ///          several in order queues in turn otherwise, see the
+    ///          ConcurrentQueues option. Kernels aren't placed, even with the
+    ///          DevicePlacement option, and they are all profiled unless
+    ///          profiling is off. The kernel becomes the last command.
+    /// \warning Kernels depending on each other have to be given the events
+    ///          of the kernels they depend on
+    ///
+    cl_int EnqueueKernel(const cl::Kernel & Kernel, const cl::NDRange & GlobalSize,
+                         const cl::NDRange & LocalSize, const std::vector<cl::Event> & WaitList,
+                         cl::Event & Done) {
+        INIT(Queue);
+
+        assert(mDevices != 0);
+        assert(mContext != 0);
+        assert(mQueue != 0);
+
+        if (mConcurrentQueues.empty()) {
+            cl_int Error = InitializeConcurrentQueues();
+            if (Error != CL_SUCCESS) {
+                return Error;
+            }
+        }
+
+        unsigned long Index = mConcurrentNext;
+        mConcurrentNext = (mConcurrentNext + 1) % mConcurrentQueues.size();
+
+        cl::CommandQueue * Queue = &mConcurrentQueues[Index];
+        bool Profiled = (mProfilingMode != ProfilingOff);
+        KernelWorkload Workload = mWorkload;
+        mWorkload.Flops = mWorkload.Bytes = 0;
+
+        std::string Name;
+        if (Instrumentation::Enabled && Profiled) {
+            Name = Kernel.getInfo<CL_KERNEL_FUNCTION_NAME>();
+        }
+
+        //
+        // Order the kernel after the commands that aren't concurrent
+        //
+        std::vector<cl::Event> Events(WaitList);
+        if (mOrderedEvent() != 0) {
+            Events.push_back(mOrderedEvent);
+        }
+
+        cl_ulong HostBegin = (Instrumentation::Enabled && Profiled ? GetHostTime() : 0);
+        cl_int Error = Queue->enqueueNDRangeKernel(Kernel, cl::NullRange, GlobalSize, LocalSize,
+                                                   (Events.empty() ? 0 : &Events), &Done);
+        cl_ulong HostEnd = (Instrumentation::Enabled && Profiled ? GetHostTime() : 0);
+        if (Error == CL_SUCCESS) {
+            mEvent = Done;
+            mLastQueue = Queue;
+            mConcurrentPending = true;
+            if (Instrumentation::Enabled) {
+                mCounters.KernelLaunches++;
+            }
+
+            if (Instrumentation::Enabled && Profiled) {
+                mRecorder.Record(KernelCommand, Name, Workload.Bytes, Workload.Flops, GlobalSize,
+                                 LocalSize, mEvent, mConcurrentIndices[Index], HostBegin, HostEnd);
+            }
+        }
+
+        return Error;
+    }
+
+    ///
+    /// \fn      FlushKernels
+    /// \return  Any error code of cl::CommandQueue::flush
+    /// \brief   This function submits all the kernels queued by EnqueueKernel()
+    ///
+    cl_int FlushKernels() {
+        for (size_t i = 0; i < mConcurrentQueues.size(); i++) {
+            cl_int Error = mConcurrentQueues[i].flush();
+            if (Error != CL_SUCCESS) {
+                return Error;
+            }
+        }
+
+        return CL_SUCCESS;
+    }
+
+    ///
+    /// \fn      WaitForEvents
+    /// \param   Events Events to wait for
+    /// \return  Any error code of cl::Event::waitForEvents
+    /// \brief   This function will block the caller until all the events are done
+    ///
+    cl_int WaitForEvents(const std::vector<cl::Event> & Events) {
+        if (Events.empty()) {
+            return CL_SUCCESS;
+        }
+
+        return cl::Event::waitForEvents(Events);
+    }
+
     ///
     /// \fn     WaitForLastEvent
     /// \return Any error code of cl::Event::wait
@@ -813,8 +2953,42 @@ public:
         assert(mContext != 0);
         assert(mQueue != 0);
 
-        return mQueue->enqueueWriteBuffer(Buffer, true, 0, sizeof (T) * Size, Host,
-                                          0, &mEvent);
+        cl::CommandQueue * Queue;
+        bool Profiled = SelectQueue(Queue);
+
+        cl_ulong HostBegin = (Instrumentation::Enabled && Profiled ? GetHostTime() : 0);
+        cl_int Error = Queue->enqueueWriteBuffer(Buffer, true, 0, sizeof (T) * Size,
+                                                 Host, GetWaitList(Queue), &mEvent);
+        cl_ulong HostEnd = (Instrumentation::Enabled && Profiled ? GetHostTime() : 0);
+        if (Error == CL_SUCCESS) {
+            SetLastCommand(Queue);
+            if (Instrumentation::Enabled) {
+                mCounters.BytesWritten += sizeof(T) * Size;
+            }
+
+            if (Instrumentation::Enabled && Profiled) {
+                mRecorder.Record(WriteCommand, "", sizeof(T) * Size, 0, cl::NullRange,
+                                 cl::NullRange, mEvent, mQueueIndex, HostBegin, HostEnd);
+            }
+        }
+
+        return Error;
     }
 };
+
+#ifndef OPENCLWRAPPER_INSTRUMENTATION
+///
+/// \def     OPENCLWRAPPER_INSTRUMENTATION
+/// \brief   Instrumentation policy used by the OpenCL class
+/// \details Define it to NoInstrumentation to compile out all the
+///          instrumentation in release builds.
+///
+#define OPENCLWRAPPER_INSTRUMENTATION FullTracing
+#endif
+
+///
+/// \typedef OpenCL
+/// \brief   Wrapper class using the default instrumentation policy
+///
+typedef BasicOpenCL<OPENCLWRAPPER_INSTRUMENTATION> OpenCL;
 }
@@ -0,0 +1,768 @@
+///
+/// \file    OpenCLBenchmark.cpp
+/// \brief   Micro-benchmarks of the OpenCL wrapper overheads
+/// \details This program measures the costs of the wrapper itself on any
+///          available OpenCL device and outputs them as JSON. Results can be
+///          saved as a named baseline, and later runs compared to it, so
+///          that regressions are caught after a driver or wrapper upgrade.
+/// \date    17-10-2026
+///
+
+#include "OpenCL.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+///
+/// \struct  BenchmarkResult
+/// \brief   Samples of a single benchmark
+///
+struct BenchmarkResult {
+    /// Name of the benchmark, including its parameters
+    std::string         Name;
+    /// Unit of the samples
+    std::string         Unit;
+    /// Whether a higher value is better
+    bool                HigherIsBetter;
+    /// Measured samples
+    std::vector<double> Samples;
+};
+
+///
+/// \struct  BenchmarkComparison
+/// \brief   Comparison of a benchmark with its baseline
+///
+struct BenchmarkComparison {
+    /// Whether the benchmark was found in the baseline
+    bool   Found;
+    /// Median of the baseline samples
+    double BaselineMedian;
+    /// Relative change of the median, positive when worse
+    double Change;
+    /// Two-sided p-value of the Mann-Whitney U test
+    double PValue;
+    /// Whether the change is significant and beyond the threshold
+    bool   Regression;
+    /// Whether the change is significant and beyond the threshold, for the better
+    bool   Improvement;
+};
+
+///
+/// \struct  BenchmarkOptions
+/// \brief   Options of the benchmark run
+///
+struct BenchmarkOptions {
+    /// Number of samples per benchmark
+    unsigned int   Iterations;
+    /// Type of the device to benchmark
+    cl_device_type Target;
+    /// File in which results are written, stdout if empty
+    std::string    Output;
+    /// Name of the baseline to save the results to, none if empty
+    std::string    Save;
+    /// Name of the baseline to compare the results with, none if empty
+    std::string    Compare;
+    /// Relative change of the median above which a change is reported
+    double         Threshold;
+    /// Significance level of the comparison
+    double         Alpha;
+};
+
+///
+/// \fn     PrintUsage
+/// \param  ProgName Name of the executable being run
+/// \return 0
+/// \brief  This function displays the information line about how to use the program
+///
+static int PrintUsage(const char * ProgName) {
+    std::cout << ProgName << ": [-i Iterations] [-t cpu|gpu|accelerator|all] [-o Output.json]"
+              << " [-s Baseline] [-c Baseline] [-r Threshold%] [-a Alpha]" << std::endl;
+    return 0;
+}
+
+///
+/// \fn     GetMedian
+/// \param  Samples Samples of which the median is computed
+/// \return The median of the samples, 0 if empty
+///
+static double GetMedian(std::vector<double> Samples) {
+    if (Samples.empty()) {
+        return 0.0;
+    }
+
+    std::sort(Samples.begin(), Samples.end());
+    size_t Middle = Samples.size() / 2;
+
+    return ((Samples.size() % 2) ? Samples[Middle] :
+                                   (Samples[Middle - 1] + Samples[Middle]) / 2.0);
+}
+
+///
+/// \fn     GetMean
+/// \param  Samples Samples of which the mean is computed
+/// \return The mean of the samples, 0 if empty
+///
+static double GetMean(const std::vector<double> & Samples) {
+    double Total = 0.0;
+
+    for (size_t i = 0; i < Samples.size(); i++) {
+        Total += Samples[i];
+    }
+
+    return (Samples.empty() ? 0.0 : Total / Samples.size());
+}
+
+///
+/// \fn     GetEmptyKernelSource
+/// \param  Arguments Number of arguments of the kernel
+/// \return The source of an empty kernel taking the given number of buffers
+///
+static std::string GetEmptyKernelSource(unsigned int Arguments) {
+    std::ostringstream Source;
+
+    Source << "__kernel void Empty" << Arguments << "(";
+    for (unsigned int i = 0; i < Arguments; i++) {
+        Source << (i == 0 ? "" : ", ") << "__global float * Arg" << i;
+    }
+    Source << ") {\n}\n";
+
+    return Source.str();
+}
+
+///
+/// \fn     LaunchEmptyKernel
+/// \param  Ocl       The OpenCL instance
+/// \param  Kernel    The empty kernel to launch
+/// \param  Arguments Number of arguments of the kernel
+/// \param  Buffer    Buffer passed for all the arguments
+/// \return Any error of OpenCL::ExecuteKernelFromKernel
+/// \brief  This function launches an empty kernel with the given number of arguments
+///
+static cl_int LaunchEmptyKernel(OpenCLWrapper::OpenCL & Ocl, const cl::Kernel & Kernel,
+                                unsigned int Arguments, const cl::Buffer & Buffer) {
+    const cl::Buffer & B = Buffer;
+
+    switch (Arguments) {
+        case 0:
+            return Ocl.ExecuteKernelFromKernel(Kernel, 1);
+        case 1:
+            return Ocl.ExecuteKernelFromKernel(Kernel, 1, B);
+        case 2:
+            return Ocl.ExecuteKernelFromKernel(Kernel, 1, B, B);
+        case 4:
+            return Ocl.ExecuteKernelFromKernel(Kernel, 1, B, B, B, B);
+        case 8:
+            return Ocl.ExecuteKernelFromKernel(Kernel, 1, B, B, B, B, B, B, B, B);
+        default:
+            return CL_INVALID_VALUE;
+    }
+}
+
+///
+/// \fn     BenchmarkLaunches
+/// \param  Ocl     The OpenCL instance
+/// \param  Options Options of the run
+/// \param  Results List to which results are appended
+/// \return CL_SUCCESS or any OpenCL error
+/// \brief  This function measures the launch overhead of ExecuteKernelFromKernel()
+/// \details For each number of arguments, it measures the host time spent
+///          queuing the kernel and the full round-trip until it is done.
+///
+static cl_int BenchmarkLaunches(OpenCLWrapper::OpenCL & Ocl, const BenchmarkOptions & Options,
+                                std::vector<BenchmarkResult> & Results) {
+    static const unsigned int Arguments[] = { 0, 1, 2, 4, 8 };
+
+    cl::Buffer Buffer;
+    cl_int Error = Ocl.AllocateBuffer<float>(1, Buffer);
+    if (Error != CL_SUCCESS) {
+        return Error;
+    }
+
+    for (size_t i = 0; i < sizeof(Arguments) / sizeof(Arguments[0]); i++) {
+        std::ostringstream Name;
+        Name << "Empty" << Arguments[i];
+
+        cl::Kernel Kernel;
+        Error = Ocl.GetKernelFromSource(GetEmptyKernelSource(Arguments[i]), Name.str().c_str(), Kernel);
+        if (Error != CL_SUCCESS) {
+            return Error;
+        }
+
+        //
+        // Warm up once, so that lazy initialization isn't measured
+        //
+        Error = LaunchEmptyKernel(Ocl, Kernel, Arguments[i], Buffer);
+        if (Error != CL_SUCCESS) {
+            return Error;
+        }
+        Ocl.WaitForLastEvent();
+
+        BenchmarkResult Enqueue = { "launch_enqueue/args=", "ns", false, std::vector<double>() };
+        BenchmarkResult RoundTrip = { "launch_roundtrip/args=", "ns", false, std::vector<double>() };
+        Enqueue.Name += Name.str().substr(5);
+        RoundTrip.Name += Name.str().substr(5);
+
+        for (unsigned int j = 0; j < Options.Iterations; j++) {
+            cl_ulong Begin = OpenCLWrapper::GetHostTime();
+            Error = LaunchEmptyKernel(Ocl, Kernel, Arguments[i], Buffer);
+            cl_ulong Queued = OpenCLWrapper::GetHostTime();
+            if (Error != CL_SUCCESS) {
+                return Error;
+            }
+
+            Ocl.WaitForLastEvent();
+            cl_ulong Done = OpenCLWrapper::GetHostTime();
+
+            Enqueue.Samples.push_back(static_cast<double>(Queued - Begin));
+            RoundTrip.Samples.push_back(static_cast<double>(Done - Begin));
+        }
+
+        Results.push_back(Enqueue);
+        Results.push_back(RoundTrip);
+    }
+
+    return CL_SUCCESS;
+}
+
+///
+/// \fn     BenchmarkBuilds
+/// \param  Ocl     The OpenCL instance
+/// \param  Options Options of the run
+/// \param  Results List to which results are appended
+/// \return CL_SUCCESS or any OpenCL error
+/// \brief  This function measures GetProgramFromSource() build times
+/// \details Cold builds use a different source each time so that neither the
+///          wrapper nor the driver can use a cache. Cached builds use the
+///          same source again and are served by the wrapper program cache.
+///
+static cl_int BenchmarkBuilds(OpenCLWrapper::OpenCL & Ocl, const BenchmarkOptions & Options,
+                              std::vector<BenchmarkResult> & Results) {
+    BenchmarkResult Cold = { "build_cold", "ns", false, std::vector<double>() };
+    BenchmarkResult Cached = { "build_cached", "ns", false, std::vector<double>() };
+    std::string Base = "__kernel void Saxpy(__global float * x, __global float * y, float a) {\n"
+                       "    size_t i = get_global_id(0);\n"
+                       "    y[i] = a * x[i] + y[i];\n"
+                       "}\n";
+    cl_ulong Run = OpenCLWrapper::GetHostTime();
+
+    for (unsigned int i = 0; i < Options.Iterations; i++) {
+        std::ostringstream Source;
+        Source << "// " << Run << " " << i << "\n" << Base;
+
+        cl::Program Program;
+        cl_ulong Begin = OpenCLWrapper::GetHostTime();
+        cl_int Error = Ocl.GetProgramFromSource(Source.str(), Program);
+        cl_ulong Built = OpenCLWrapper::GetHostTime();
+        if (Error != CL_SUCCESS) {
+            return Error;
+        }
+
+        Error = Ocl.GetProgramFromSource(Source.str(), Program);
+        cl_ulong Found = OpenCLWrapper::GetHostTime();
+        if (Error != CL_SUCCESS) {
+            return Error;
+        }
+
+        Cold.Samples.push_back(static_cast<double>(Built - Begin));
+        Cached.Samples.push_back(static_cast<double>(Found - Built));
+    }
+
+    Ocl.ClearProgramCache();
+    Results.push_back(Cold);
+    Results.push_back(Cached);
+
+    return CL_SUCCESS;
+}
+
+///
+/// \fn     BenchmarkAllocations
+/// \param  Ocl     The OpenCL instance
+/// \param  Options Options of the run
+/// \param  Results List to which results are appended
+/// \return CL_SUCCESS or any OpenCL error
+/// \brief  This function measures AllocateBuffer() latency for several sizes
+///
+static cl_int BenchmarkAllocations(OpenCLWrapper::OpenCL & Ocl, const BenchmarkOptions & Options,
+                                   std::vector<BenchmarkResult> & Results) {
+    for (size_t Size = 1024; Size <= 64 * 1024 * 1024; Size *= 16) {
+        std::ostringstream Name;
+        Name << "allocate/bytes=" << Size;
+        BenchmarkResult Result = { Name.str(), "ns", false, std::vector<double>() };
+
+        for (unsigned int i = 0; i < Options.Iterations; i++) {
+            cl::Buffer Buffer;
+            cl_ulong Begin = OpenCLWrapper::GetHostTime();
+            cl_int Error = Ocl.AllocateBuffer<char>(Size, Buffer);
+            cl_ulong End = OpenCLWrapper::GetHostTime();
+            if (Error != CL_SUCCESS) {
+                return Error;
+            }
+
+            Result.Samples.push_back(static_cast<double>(End - Begin));
+        }
+
+        Results.push_back(Result);
+    }
+
+    return CL_SUCCESS;
+}
+
+///
+/// \fn     BenchmarkTransfers
+/// \param  Ocl     The OpenCL instance
+/// \param  Options Options of the run
+/// \param  Results List to which results are appended
+/// \return CL_SUCCESS or any OpenCL error
+/// \brief  This function measures ReadBuffer() and WriteBuffer() bandwidth
+/// \details Bandwidth is computed from the profiled device time of each
+///          transfer, for sizes going from 4 KB to 64 MB.
+///
+static cl_int BenchmarkTransfers(OpenCLWrapper::OpenCL & Ocl, const BenchmarkOptions & Options,
+                                 std::vector<BenchmarkResult> & Results) {
+    for (size_t Size = 4096; Size <= 64 * 1024 * 1024; Size *= 4) {
+        std::vector<char> Host(Size, 1);
+        cl::Buffer Buffer;
+        cl_int Error = Ocl.AllocateBuffer<char>(Size, Buffer);
+        if (Error != CL_SUCCESS) {
+            return Error;
+        }
+
+        std::ostringstream Suffix;
+        Suffix << "/bytes=" << Size;
+        BenchmarkResult Write = { "write_bandwidth" + Suffix.str(), "GB/s", true, std::vector<double>() };
+        BenchmarkResult Read = { "read_bandwidth" + Suffix.str(), "GB/s", true, std::vector<double>() };
+
+        for (unsigned int i = 0; i < Options.Iterations; i++) {
+            cl_ulong Elapsed;
+
+            Error = Ocl.WriteBuffer(Buffer, &Host[0], Size);
+            if (Error != CL_SUCCESS) {
+                return Error;
+            }
+
+            Error = Ocl.GetLastElapsedTime(&Elapsed);
+            if (Error != CL_SUCCESS) {
+                return Error;
+            }
+            Write.Samples.push_back(Elapsed == 0 ? 0.0 : static_cast<double>(Size) / Elapsed);
+
+            Error = Ocl.ReadBuffer(Buffer, &Host[0], Size);
+            if (Error != CL_SUCCESS) {
+                return Error;
+            }
+
+            Error = Ocl.GetLastElapsedTime(&Elapsed);
+            if (Error != CL_SUCCESS) {
+                return Error;
+            }
+            Read.Samples.push_back(Elapsed == 0 ? 0.0 : static_cast<double>(Size) / Elapsed);
+        }
+
+        Results.push_back(Write);
+        Results.push_back(Read);
+    }
+
+    return CL_SUCCESS;
+}
+
+///
+/// \fn     BenchmarkGridSizes
+/// \param  Ocl     The OpenCL instance
+/// \param  Options Options of the run
+/// \param  Results List to which results are appended
+/// \brief  This function measures the cost of GetGridSize()
+/// \details A prime size is the worst case, as no divisor is found.
+///
+static void BenchmarkGridSizes(OpenCLWrapper::OpenCL & Ocl, const BenchmarkOptions & Options,
+                               std::vector<BenchmarkResult> & Results) {
+    static const long Sizes[] = { 256, 1024 * 1024, 1000003 };
+    const unsigned int Calls = 1000;
+
+    for (size_t i = 0; i < sizeof(Sizes) / sizeof(Sizes[0]); i++) {
+        std::ostringstream Name;
+        Name << "grid_size/size=" << Sizes[i];
+        BenchmarkResult Result = { Name.str(), "ns", false, std::vector<double>() };
+
+        for (unsigned int j = 0; j < Options.Iterations; j++) {
+            cl::NDRange LocalSize, GlobalSize;
+            cl_ulong Begin = OpenCLWrapper::GetHostTime();
+            for (unsigned int k = 0; k < Calls; k++) {
+                Ocl.GetGridSize(LocalSize, GlobalSize, Sizes[i]);
+            }
+            cl_ulong End = OpenCLWrapper::GetHostTime();
+
+            Result.Samples.push_back(static_cast<double>(End - Begin) / Calls);
+        }
+
+        Results.push_back(Result);
+    }
+}
+
+///
+/// \fn     GetBaselineFile
+/// \param  Name Name of the baseline
+/// \return The file in which the baseline is stored
+///
+static std::string GetBaselineFile(const std::string & Name) {
+    return Name + ".baseline";
+}
+
+///
+/// \fn     SaveBaseline
+/// \param  Name    Name of the baseline
+/// \param  Results Results of all the benchmarks
+/// \return true in case of success, false otherwise
+/// \brief  This function stores the samples of all the benchmarks
+/// \details Each benchmark is a line made of its name, its unit, whether
+///          higher is better and all its samples, separated by spaces.
+///
+static bool SaveBaseline(const std::string & Name, const std::vector<BenchmarkResult> & Results) {
+    std::ofstream File(GetBaselineFile(Name).c_str());
+    if (!File.is_open()) {
+        return false;
+    }
+
+    File.precision(17);
+    for (size_t i = 0; i < Results.size(); i++) {
+        File << Results[i].Name << " " << Results[i].Unit << " " << Results[i].HigherIsBetter;
+        for (size_t j = 0; j < Results[i].Samples.size(); j++) {
+            File << " " << Results[i].Samples[j];
+        }
+        File << "\n";
+    }
+
+    return File.good();
+}
+
+///
+/// \fn     LoadBaseline
+/// \param  Name    Name of the baseline
+/// \param  Results Results stored in the baseline
+/// \return true in case of success, false otherwise
+/// \brief  This function reads a baseline written by SaveBaseline()
+///
+static bool LoadBaseline(const std::string & Name, std::vector<BenchmarkResult> & Results) {
+    std::ifstream File(GetBaselineFile(Name).c_str());
+    std::string Line;
+
+    if (!File.is_open()) {
+        return false;
+    }
+
+    while (std::getline(File, Line)) {
+        std::istringstream Fields(Line);
+        BenchmarkResult Result;
+        double Sample;
+
+        if (!(Fields >> Result.Name >> Result.Unit >> Result.HigherIsBetter)) {
+            return false;
+        }
+
+        while (Fields >> Sample) {
+            Result.Samples.push_back(Sample);
+        }
+
+        Results.push_back(Result);
+    }
+
+    return true;
+}
+
+///
+/// \fn     GetMannWhitneyPValue
+/// \param  First  Samples of the first run
+/// \param  Second Samples of the second run
+/// \return The two-sided p-value that both runs have the same distribution
+/// \brief  This function runs a Mann-Whitney U test
+/// \details The test doesn't assume the samples are normally distributed,
+///          which timings never are. The normal approximation of U is used,
+///          with tie and continuity corrections, so that it is only
+///          accurate with about 8 samples per run or more.
+///
+static double GetMannWhitneyPValue(const std::vector<double> & First,
+                                   const std::vector<double> & Second) {
+    std::vector<std::pair<double, int> > All;
+    double N1 = static_cast<double>(First.size());
+    double N2 = static_cast<double>(Second.size());
+    double N = N1 + N2;
+
+    if (First.empty() || Second.empty()) {
+        return 1.0;
+    }
+
+    for (size_t i = 0; i < First.size(); i++) {
+        All.push_back(std::make_pair(First[i], 0));
+    }
+    for (size_t i = 0; i < Second.size(); i++) {
+        All.push_back(std::make_pair(Second[i], 1));
+    }
+    std::sort(All.begin(), All.end());
+
+    //
+    // Sum the ranks of the first run, ties get their mean rank
+    //
+    double RankSum = 0.0, Ties = 0.0;
+    for (size_t i = 0; i < All.size(); ) {
+        size_t j = i;
+        while (j < All.size() && All[j].first == All[i].first) {
+            j++;
+        }
+
+        double Rank = (i + 1 + j) / 2.0;
+        double Count = static_cast<double>(j - i);
+        for (size_t k = i; k < j; k++) {
+            if (All[k].second == 0) {
+                RankSum += Rank;
+            }
+        }
+        Ties += Count * Count * Count - Count;
+        i = j;
+    }
+
+    double U = RankSum - N1 * (N1 + 1.0) / 2.0;
+    double Mean = N1 * N2 / 2.0;
+    double Variance = N1 * N2 / 12.0 * ((N + 1.0) - Ties / (N * (N - 1.0)));
+    if (Variance <= 0.0) {
+        return 1.0;
+    }
+
+    double Z = std::max(std::fabs(U - Mean) - 0.5, 0.0) / std::sqrt(Variance);
+    return std::erfc(Z / std::sqrt(2.0));
+}
+
+///
+/// \fn     CompareResults
+/// \param  Results     Results of all the benchmarks
+/// \param  Baseline    Results stored in the baseline
+/// \param  Options     Options of the run
+/// \param  Comparisons Comparison of each result with the baseline
+/// \return The number of regressions
+/// \brief  This function compares the results with a baseline
+/// \details A change is only reported if it is statistically significant
+///          and if the median moved by more than the threshold, so that
+///          noise isn't reported.
+///
+static unsigned int CompareResults(const std::vector<BenchmarkResult> & Results,
+                                   const std::vector<BenchmarkResult> & Baseline,
+                                   const BenchmarkOptions & Options,
+                                   std::vector<BenchmarkComparison> & Comparisons) {
+    unsigned int Regressions = 0;
+
+    Comparisons.clear();
+    for (size_t i = 0; i < Results.size(); i++) {
+        BenchmarkComparison Comparison = { false, 0.0, 0.0, 1.0, false, false };
+
+        for (size_t j = 0; j < Baseline.size(); j++) {
+            if (Baseline[j].Name != Results[i].Name) {
+                continue;
+            }
+
+            double Before = GetMedian(Baseline[j].Samples);
+            double After = GetMedian(Results[i].Samples);
+
+            Comparison.Found = true;
+            Comparison.BaselineMedian = Before;
+            if (Before != 0.0) {
+                Comparison.Change = (After - Before) / Before;
+                if (Results[i].HigherIsBetter) {
+                    Comparison.Change = -Comparison.Change;
+                }
+            }
+            Comparison.PValue = GetMannWhitneyPValue(Baseline[j].Samples, Results[i].Samples);
+
+            bool Significant = (Comparison.PValue < Options.Alpha);
+            Comparison.Regression = (Significant && Comparison.Change > Options.Threshold);
+            Comparison.Improvement = (Significant && Comparison.Change < -Options.Threshold);
+            if (Comparison.Regression) {
+                Regressions++;
+            }
+            break;
+        }
+
+        Comparisons.push_back(Comparison);
+    }
+
+    return Regressions;
+}
+
+///
+/// \fn     WriteResults
+/// \param  Stream  The stream in which results are written
+/// \param  Device  Name of the benchmarked device
+/// \param  Options Options of the run
+/// \param  Results Results of all the benchmarks
+/// \param  Comparisons Comparison of each result with the baseline, if any
+/// \brief  This function writes the results as JSON
+///
+static void WriteResults(std::ostream & Stream, const std::string & Device,
+                         const BenchmarkOptions & Options,
+                         const std::vector<BenchmarkResult> & Results,
+                         const std::vector<BenchmarkComparison> & Comparisons) {
+    Stream << "{\n  \"device\": \"" << OpenCLWrapper::EscapeJson(Device) << "\",\n"
+           << "  \"iterations\": " << Options.Iterations << ",\n";
+    if (!Options.Compare.empty()) {
+        Stream << "  \"baseline\": \"" << OpenCLWrapper::EscapeJson(Options.Compare) << "\",\n"
+               << "  \"threshold\": " << Options.Threshold << ",\n"
+               << "  \"alpha\": " << Options.Alpha << ",\n";
+    }
+    Stream
+           << "  \"results\": [";
+
+    for (size_t i = 0; i < Results.size(); i++) {
+        const BenchmarkResult & Result = Results[i];
+        std::vector<double>::const_iterator Min, Max;
+        Min = std::min_element(Result.Samples.begin(), Result.Samples.end());
+        Max = std::max_element(Result.Samples.begin(), Result.Samples.end());
+
+        Stream << (i == 0 ? "\n" : ",\n")
+               << "    {\"name\": \"" << OpenCLWrapper::EscapeJson(Result.Name) << "\", "
+               << "\"unit\": \"" << Result.Unit << "\", "
+               << "\"higher_is_better\": " << (Result.HigherIsBetter ? "true" : "false") << ", "
+               << "\"min\": " << (Result.Samples.empty() ? 0.0 : *Min) << ", "
+               << "\"median\": " << GetMedian(Result.Samples) << ", "
+               << "\"mean\": " << GetMean(Result.Samples) << ", "
+               << "\"max\": " << (Result.Samples.empty() ? 0.0 : *Max) << ", "
+               << "\"samples\": [";
+        for (size_t j = 0; j < Result.Samples.size(); j++) {
+            Stream << (j == 0 ? "" : ", ") << Result.Samples[j];
+        }
+        Stream << "]";
+
+        if (i < Comparisons.size() && Comparisons[i].Found) {
+            const BenchmarkComparison & Comparison = Comparisons[i];
+            Stream << ", \"baseline_median\": " << Comparison.BaselineMedian
+                   << ", \"change\": " << Comparison.Change
+                   << ", \"p_value\": " << Comparison.PValue
+                   << ", \"regression\": " << (Comparison.Regression ? "true" : "false")
+                   << ", \"improvement\": " << (Comparison.Improvement ? "true" : "false");
+        }
+        Stream << "}";
+    }
+
+    Stream << "\n  ]\n}\n";
+}
+
+///
+/// \fn     main
+/// \param  argc Number of passed arguments (>= 1)
+/// \param  argv All the passed arguments
+/// \return 0 in case of success, -error otherwise
+/// \brief  Main function
+///
+int main(int argc, char ** argv) {
+    BenchmarkOptions Options = { 20, CL_DEVICE_TYPE_ALL, "", "", "", 0.05, 0.01 };
+    OpenCLWrapper::OpenCL OclObject;
+    std::vector<BenchmarkResult> Results;
+    std::vector<BenchmarkResult> Baseline;
+    std::vector<BenchmarkComparison> Comparisons;
+
+    //
+    // Parse the command line
+    //
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
+            Options.Iterations = std::max(atoi(argv[++i]), 1);
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            Options.Output = argv[++i];
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            Options.Save = argv[++i];
+        } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            Options.Compare = argv[++i];
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            Options.Threshold = atof(argv[++i]) / 100.0;
+        } else if (strcmp(argv[i], "-a") == 0 && i + 1 < argc) {
+            Options.Alpha = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            std::string Type = argv[++i];
+            if (Type.compare("cpu") == 0) {
+                Options.Target = CL_DEVICE_TYPE_CPU;
+            } else if (Type.compare("gpu") == 0) {
+                Options.Target = CL_DEVICE_TYPE_GPU;
+            } else if (Type.compare("accelerator") == 0) {
+                Options.Target = CL_DEVICE_TYPE_ACCELERATOR;
+            }
+        } else {
+            return PrintUsage(argv[0]);
+        }
+    }
+
+    //
+    // Load the baseline first, so that a typo doesn't waste a run
+    //
+    if (!Options.Compare.empty() && !LoadBaseline(Options.Compare, Baseline)) {
+        std::cerr << "Could not load baseline: " << GetBaselineFile(Options.Compare) << std::endl;
+        return -4;
+    }
+
+    OclObject.SetParameter(OpenCLWrapper::TargetDevice, Options.Target);
+
+    cl::Device Device;
+    cl_int Error = OclObject.GetUsedDevice(Device);
+    if (Error != CL_SUCCESS) {
+        std::cerr << "No OpenCL device found: " << Error << std::endl;
+        return -1;
+    }
+
+    //
+    // Run all the benchmarks
+    //
+    Error = BenchmarkLaunches(OclObject, Options, Results);
+    if (Error == CL_SUCCESS) {
+        Error = BenchmarkBuilds(OclObject, Options, Results);
+    }
+
+    if (Error == CL_SUCCESS) {
+        Error = BenchmarkAllocations(OclObject, Options, Results);
+    }
+
+    if (Error == CL_SUCCESS) {
+        Error = BenchmarkTransfers(OclObject, Options, Results);
+    }
+
+    if (Error != CL_SUCCESS) {
+        std::string Log;
+        OclObject.GetLastBuildLog(Log);
+        std::cerr << "Benchmark failed: " << Error << std::endl << Log;
+        return -2;
+    }
+
+    BenchmarkGridSizes(OclObject, Options, Results);
+
+    //
+    // Compare with the baseline and report the significant changes
+    //
+    unsigned int Regressions = CompareResults(Results, Baseline, Options, Comparisons);
+    for (size_t i = 0; i < Comparisons.size(); i++) {
+        if (Comparisons[i].Regression || Comparisons[i].Improvement) {
+            std::cerr << (Comparisons[i].Regression ? "REGRESSION " : "improvement ")
+                      << Results[i].Name << ": " << Comparisons[i].BaselineMedian << " -> "
+                      << GetMedian(Results[i].Samples) << " " << Results[i].Unit
+                      << " (p = " << Comparisons[i].PValue << ")" << std::endl;
+        }
+    }
+
+    if (!Options.Save.empty() && !SaveBaseline(Options.Save, Results)) {
+        std::cerr << "Could not save baseline: " << GetBaselineFile(Options.Save) << std::endl;
+        return -5;
+    }
+
+    //
+    // Output the results
+    //
+    if (Options.Output.empty()) {
+        WriteResults(std::cout, Device.getInfo<CL_DEVICE_NAME>(), Options, Results, Comparisons);
+    } else {
+        std::ofstream Output(Options.Output.c_str());
+        if (!Output.is_open()) {
+            std::cerr << "Could not open: " << Options.Output << std::endl;
+            return -3;
+        }
+
+        WriteResults(Output, Device.getInfo<CL_DEVICE_NAME>(), Options, Results, Comparisons);
+    }
+
+    return (Regressions == 0 ? 0 : -6);
+}
@@ -0,0 +1,297 @@
+///
+/// \file    OpenCLCache.hpp
+/// \brief   Caches used by the OpenCL wrapper
+/// \details This file provides the cache that keeps built programs so that
+///          the same source isn't built twice with the same options, and the
+///          pool that keeps released buffers so that they can be reused.
+///          Both can be shared between threads.
+/// \date    17-10-2026
+///
+
+#ifndef OPENCLWRAPPER_CACHE_HPP
+#define OPENCLWRAPPER_CACHE_HPP
+
+#include <CL/cl.hpp>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace OpenCLWrapper {
+
+///
+/// \class   ProgramCache
+/// \brief   Keeps the programs built for a context
+/// \details Programs are looked up by their source and their build options.
+///          Each program is kept with its build log.
+///
+class ProgramCache {
+private:
+    ///
+    /// \struct  CachedProgram
+    /// \brief   Built program and the log of its build
+    ///
+    struct CachedProgram {
+        /// The built program
+        cl::Program Program;
+        /// Build log of the program
+        std::string Log;
+    };
+
+    /// Lock protecting the cache
+    mutable std::mutex                   mMutex;
+    /// Built programs, indexed by their key
+    std::map<std::string, CachedProgram> mPrograms;
+    /// Number of lookups that found a program
+    cl_ulong                           mHits;
+    /// Number of lookups that didn't find a program
+    cl_ulong                           mMisses;
+
+public:
+    ///
+    /// \fn      ProgramCache
+    /// \brief   Constructor that simply initializes an empty cache
+    ///
+    ProgramCache() {
+        mHits = 0;
+        mMisses = 0;
+    }
+
+    ///
+    /// \fn      GetKey
+    /// \param   Source  Source code of the program
+    /// \param   Length  Length of the source code
+    /// \param   Options Options used to build the program
+    /// \return  The key identifying the program in the cache
+    /// \brief   This function computes the key of a program
+    ///
+    static std::string GetKey(const char * Source, size_t Length,
+                              const std::string & Options) {
+        std::string Key(Options);
+
+        Key.append(1, '\0');
+        Key.append(Source, Length);
+
+        return Key;
+    }
+
+    ///
+    /// \fn      Find
+    /// \param   Key     Key of the program, as returned by GetKey()
+    /// \param   Program The cached program, if found
+    /// \param   Log     Build log of the cached program, if found
+    /// \return  true if the program was found, false otherwise
+    /// \brief   This function looks for a program in the cache
+    ///
+    bool Find(const std::string & Key, cl::Program & Program, std::string & Log) {
+        std::lock_guard<std::mutex> Lock(mMutex);
+        std::map<std::string, CachedProgram>::const_iterator it = mPrograms.find(Key);
+        if (it == mPrograms.end()) {
+            mMisses++;
+            return false;
+        }
+
+        mHits++;
+        Program = it->second.Program;
+        Log = it->second.Log;
+
+        return true;
+    }
+
+    ///
+    /// \fn      Insert
+    /// \param   Key     Key of the program, as returned by GetKey()
+    /// \param   Program The built program
+    /// \param   Log     Build log of the program
+    /// \brief   This function adds a built program to the cache
+    ///
+    void Insert(const std::string & Key, const cl::Program & Program, const std::string & Log) {
+        std::lock_guard<std::mutex> Lock(mMutex);
+        mPrograms[Key].Program = Program;
+        mPrograms[Key].Log = Log;
+    }
+
+    ///
+    /// \fn      GetHits
+    /// \return  The number of lookups that found a program
+    ///
+    cl_ulong GetHits() const {
+        std::lock_guard<std::mutex> Lock(mMutex);
+        return mHits;
+    }
+
+    ///
+    /// \fn      GetMisses
+    /// \return  The number of lookups that didn't find a program
+    ///
+    cl_ulong GetMisses() const {
+        std::lock_guard<std::mutex> Lock(mMutex);
+        return mMisses;
+    }
+
+    ///
+    /// \fn    Clear
+    /// \brief This function drops all the cached programs
+    ///
+    void Clear() {
+        std::lock_guard<std::mutex> Lock(mMutex);
+        mPrograms.clear();
+    }
+};
+
+///
+/// \class   BufferPool
+/// \brief   Keeps released buffers of a context for reuse
+/// \details Buffers are looked up by their flags and their exact size, as
+///          kernels usually rely on the size of their buffers. Once the
+///          pooled buffers reach the capacity, released buffers are freed.
+///
+class BufferPool {
+private:
+    /// Key identifying a buffer: its flags and its size
+    typedef std::pair<cl_mem_flags, size_t> BufferKey;
+
+    /// Lock protecting the pool
+    mutable std::mutex                           mMutex;
+    /// Released buffers, indexed by their key
+    std::map<BufferKey, std::vector<cl::Buffer> > mBuffers;
+    /// Bytes of all the released buffers
+    cl_ulong                                     mPooled;
+    /// Maximum number of bytes kept
+    cl_ulong                                     mCapacity;
+    /// Number of acquisitions that reused a buffer
+    cl_ulong                                     mHits;
+    /// Number of acquisitions that allocated a buffer
+    cl_ulong                                     mMisses;
+
+public:
+    ///
+    /// \fn      BufferPool
+    /// \brief   Constructor that simply initializes an empty pool
+    /// \details By default, up to 256 MB of buffers are kept.
+    ///
+    BufferPool() {
+        mPooled = 0;
+        mCapacity = 256 * 1024 * 1024;
+        mHits = 0;
+        mMisses = 0;
+    }
+
+    ///
+    /// \fn      Acquire
+    /// \param   Context Context in which the buffer is allocated
+    /// \param   Flags   Flags of the buffer
+    /// \param   Size    Size of the buffer in bytes
+    /// \param   Buffer  Acquired buffer
+    /// \return  Any of the cl::Buffer error code
+    /// \brief   This function reuses a released buffer or allocates one
+    /// \details Reused buffers keep the content they were released with.
+    ///
+    cl_int Acquire(const cl::Context & Context, cl_mem_flags Flags, size_t Size,
+                   cl::Buffer & Buffer) {
+        {
+            std::lock_guard<std::mutex> Lock(mMutex);
+            std::map<BufferKey, std::vector<cl::Buffer> >::iterator it;
+            it = mBuffers.find(std::make_pair(Flags, Size));
+            if (it != mBuffers.end() && !it->second.empty()) {
+                Buffer = it->second.back();
+                it->second.pop_back();
+                mPooled -= Size;
+                mHits++;
+                return CL_SUCCESS;
+            }
+
+            mMisses++;
+        }
+
+        cl_int Error;
+        Buffer = cl::Buffer(Context, Flags, Size, 0, &Error);
+
+        return Error;
+    }
+
+    ///
+    /// \fn      Release
+    /// \param   Buffer Buffer to give back to the pool
+    /// \return  Any of the cl::Memory::getInfo error code
+    /// \brief   This function gives a buffer back for reuse
+    /// \details If the pool is full, the buffer is freed once the caller
+    ///          drops it. Buffers using host memory are never pooled.
+    ///
+    cl_int Release(const cl::Buffer & Buffer) {
+        cl_int Error;
+
+        cl_mem_flags Flags = Buffer.getInfo<CL_MEM_FLAGS>(&Error);
+        if (Error != CL_SUCCESS) {
+            return Error;
+        }
+
+        size_t Size = Buffer.getInfo<CL_MEM_SIZE>(&Error);
+        if (Error != CL_SUCCESS) {
+            return Error;
+        }
+
+        if (Flags & CL_MEM_USE_HOST_PTR) {
+            return CL_SUCCESS;
+        }
+
+        std::lock_guard<std::mutex> Lock(mMutex);
+        if (mPooled + Size <= mCapacity) {
+            mBuffers[std::make_pair(Flags, Size)].push_back(Buffer);
+            mPooled += Size;
+        }
+
+        return CL_SUCCESS;
+    }
+
+    ///
+    /// \fn      SetCapacity
+    /// \param   Capacity Maximum number of bytes kept
+    /// \brief   This function changes the capacity of the pool
+    /// \details Buffers already pooled are kept until they are acquired.
+    ///
+    void SetCapacity(cl_ulong Capacity) {
+        std::lock_guard<std::mutex> Lock(mMutex);
+        mCapacity = Capacity;
+    }
+
+    ///
+    /// \fn      GetPooledBytes
+    /// \return  The number of bytes of all the released buffers
+    ///
+    cl_ulong GetPooledBytes() const {
+        std::lock_guard<std::mutex> Lock(mMutex);
+        return mPooled;
+    }
+
+    ///
+    /// \fn      GetHits
+    /// \return  The number of acquisitions that reused a buffer
+    ///
+    cl_ulong GetHits() const {
+        std::lock_guard<std::mutex> Lock(mMutex);
+        return mHits;
+    }
+
+    ///
+    /// \fn      GetMisses
+    /// \return  The number of acquisitions that allocated a buffer
+    ///
+    cl_ulong GetMisses() const {
+        std::lock_guard<std::mutex> Lock(mMutex);
+        return mMisses;
+    }
+
+    ///
+    /// \fn    Clear
+    /// \brief This function frees all the released buffers
+    ///
+    void Clear() {
+        std::lock_guard<std::mutex> Lock(mMutex);
+        mBuffers.clear();
+        mPooled = 0;
+    }
+};
+}
+
+#endif
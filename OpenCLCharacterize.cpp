@@ -0,0 +1,576 @@
+///
+/// \file    OpenCLCharacterize.cpp
+/// \brief   Characterization of the available OpenCL devices
+/// \details This program measures the memory bandwidth, the compute
+///          throughput, the atomic throughput, the local memory bandwidth
+///          and the launch latency of each available device and writes them
+///          to a device profile file. This file can then be loaded by the
+///          wrapper with the DeviceProfiles option.
+/// \date    17-10-2026
+///
+
+#include "OpenCL.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+///
+/// \def     PEAK_LOOPS
+/// \brief   Number of iterations of the peak FLOP kernels
+///
+#define PEAK_LOOPS 128
+
+///
+/// \def     PEAK_MADS
+/// \brief   Number of mad per iteration of the peak FLOP kernels
+///
+#define PEAK_MADS 16
+
+///
+/// \def     ATOMIC_LOOPS
+/// \brief   Number of atomic operations per work-item
+///
+#define ATOMIC_LOOPS 16
+
+///
+/// \def     LOCAL_LOOPS
+/// \brief   Number of local memory reads per work-item
+///
+#define LOCAL_LOOPS 256
+
+///
+/// \def     STRINGIFY
+/// \brief   Turns the value of a macro into a string literal
+///
+#define STRINGIFY(x)  STRINGIFY_(x)
+#define STRINGIFY_(x) #x
+
+///
+/// \var     Kernels
+/// \brief   Source of all the characterization kernels, but the peak FLOP ones
+///
+static const char Kernels[] =
+    "__kernel void Empty() {\n"
+    "}\n"
+    "__kernel void Copy(__global const float * a, __global float * c) {\n"
+    "    size_t i = get_global_id(0);\n"
+    "    c[i] = a[i];\n"
+    "}\n"
+    "__kernel void Scale(__global float * b, __global const float * c, float s) {\n"
+    "    size_t i = get_global_id(0);\n"
+    "    b[i] = s * c[i];\n"
+    "}\n"
+    "__kernel void Add(__global const float * a, __global const float * b, __global float * c) {\n"
+    "    size_t i = get_global_id(0);\n"
+    "    c[i] = a[i] + b[i];\n"
+    "}\n"
+    "__kernel void Triad(__global float * a, __global const float * b, __global const float * c, float s) {\n"
+    "    size_t i = get_global_id(0);\n"
+    "    a[i] = b[i] + s * c[i];\n"
+    "}\n"
+    "__kernel void Atomic(__global int * Counters) {\n"
+    "    size_t i = get_global_id(0);\n"
+    "    for (int j = 0; j < " STRINGIFY(ATOMIC_LOOPS) "; j++) {\n"
+    "        atomic_inc(&Counters[(i + j) & 1023]);\n"
+    "    }\n"
+    "}\n"
+    "__kernel void Local(__global float * Out, __local float * Tile) {\n"
+    "    size_t l = get_local_id(0), n = get_local_size(0);\n"
+    "    float Sum = 0.0f;\n"
+    "    Tile[l] = l;\n"
+    "    barrier(CLK_LOCAL_MEM_FENCE);\n"
+    "    for (int j = 0; j < " STRINGIFY(LOCAL_LOOPS) "; j++) {\n"
+    "        Sum += Tile[(l + j) & (n - 1)];\n"
+    "    }\n"
+    "    Out[get_global_id(0)] = Sum;\n"
+    "}\n";
+
+///
+/// \fn     PrintUsage
+/// \param  ProgName Name of the executable being run
+/// \return 0
+/// \brief  This function displays the information line about how to use the program
+///
+static int PrintUsage(const char * ProgName) {
+    std::cout << ProgName << ": [-i Iterations] [-o Profiles]" << std::endl;
+    return 0;
+}
+
+///
+/// \fn     GetPeakKernelSource
+/// \param  Width Vector width of the kernel
+/// \return The source of the peak FLOP kernel for the given vector width
+/// \brief  This function generates a kernel chaining dependent mad
+/// \details Two dependency chains are interleaved so that the mad latency is
+///          hidden. With a zero seed, no denormal nor infinity is produced.
+///
+static std::string GetPeakKernelSource(unsigned int Width) {
+    std::ostringstream Source;
+    std::ostringstream Type;
+
+    Type << "float";
+    if (Width > 1) {
+        Type << Width;
+    }
+
+    Source << "__kernel void Peak(__global " << Type.str() << " * Out, float Seed) {\n"
+           << "    " << Type.str() << " x = (" << Type.str() << ")(Seed + get_global_id(0));\n"
+           << "    " << Type.str() << " y = (" << Type.str() << ")(Seed);\n"
+           << "    for (int i = 0; i < " << PEAK_LOOPS << "; i++) {\n";
+    for (unsigned int i = 0; i < PEAK_MADS / 2; i++) {
+        Source << "        x = mad(y, x, y);\n"
+               << "        y = mad(x, y, x);\n";
+    }
+    Source << "    }\n"
+           << "    Out[get_global_id(0)] = x + y;\n"
+           << "}\n";
+
+    return Source.str();
+}
+
+///
+/// \fn     GetBestTime
+/// \tparam Launch     Type of the functor queuing the command
+/// \param  Ocl        The OpenCL instance
+/// \param  Iterations Number of times the command is run
+/// \param  Queue      Functor queuing the command
+/// \param  Best       Shortest device time of the command in ns
+/// \return CL_SUCCESS or any OpenCL error
+/// \brief  This function runs a command several times and keeps its best device time
+/// \details Keeping the best time ignores the first run warm up.
+///
+template<typename Launch>
+static cl_int GetBestTime(OpenCLWrapper::OpenCL & Ocl, unsigned int Iterations,
+                          Launch Queue, cl_ulong & Best) {
+    Best = std::numeric_limits<cl_ulong>::max();
+
+    for (unsigned int i = 0; i < Iterations; i++) {
+        cl_ulong Elapsed;
+
+        cl_int Error = Queue();
+        if (Error != CL_SUCCESS) {
+            return Error;
+        }
+
+        Error = Ocl.WaitForLastEvent();
+        if (Error != CL_SUCCESS) {
+            return Error;
+        }
+
+        Error = Ocl.GetLastElapsedTime(&Elapsed);
+        if (Error != CL_SUCCESS) {
+            return Error;
+        }
+
+        Best = std::min(Best, std::max(Elapsed, static_cast<cl_ulong>(1)));
+    }
+
+    return CL_SUCCESS;
+}
+
+///
+/// \fn     MeasureLatency
+/// \param  Ocl        The OpenCL instance
+/// \param  Program    Program with the characterization kernels
+/// \param  Iterations Number of measurements
+/// \param  Profile    Profile in which the latency is stored
+/// \return CL_SUCCESS or any OpenCL error
+/// \brief  This function measures the host round-trip of an empty kernel
+/// \details The median is kept, as the launch latency is noisy.
+///
+static cl_int MeasureLatency(OpenCLWrapper::OpenCL & Ocl, const cl::Program & Program,
+                             unsigned int Iterations, OpenCLWrapper::DeviceProfile & Profile) {
+    std::vector<cl_ulong> Samples;
+    cl::Kernel Kernel;
+
+    cl_int Error = Ocl.GetKernelFromProgram(Program, "Empty", Kernel);
+    if (Error != CL_SUCCESS) {
+        return Error;
+    }
+
+    for (unsigned int i = 0; i <= Iterations; i++) {
+        cl_ulong Begin = OpenCLWrapper::GetHostTime();
+        Error = Ocl.ExecuteKernelOnRange(Kernel, cl::NDRange(1), cl::NullRange);
+        if (Error != CL_SUCCESS) {
+            return Error;
+        }
+
+        Error = Ocl.WaitForLastEvent();
+        if (Error != CL_SUCCESS) {
+            return Error;
+        }
+
+        //
+        // Skip the first launch, it includes the lazy initializations
+        //
+        if (i != 0) {
+            Samples.push_back(OpenCLWrapper::GetHostTime() - Begin);
+        }
+    }
+
+    std::sort(Samples.begin(), Samples.end());
+    Profile.LaunchLatency = static_cast<double>(Samples[Samples.size() / 2]);
+
+    return CL_SUCCESS;
+}
+
+///
+/// \fn     MeasureStream
+/// \param  Ocl        The OpenCL instance
+/// \param  Program    Program with the characterization kernels
+/// \param  Iterations Number of measurements
+/// \param  Profile    Profile in which the bandwidths are stored
+/// \return CL_SUCCESS or any OpenCL error
+/// \brief  This function runs the STREAM kernels and the host/device transfers
+/// \details Arrays of up to 16M floats are used, within the maximum
+///          allocation size of the device.
+///
+static cl_int MeasureStream(OpenCLWrapper::OpenCL & Ocl, const cl::Program & Program,
+                            unsigned int Iterations, OpenCLWrapper::DeviceProfile & Profile) {
+    cl::Device Device;
+    cl::Buffer A, B, C;
+    cl::Kernel Copy, Scale, Add, Triad;
+    cl_ulong Best;
+    float Scalar = 3.0f;
+
+    cl_int Error = Ocl.GetUsedDevice(Device);
+    if (Error != CL_SUCCESS) {
+        return Error;
+    }
+
+    size_t Size = static_cast<size_t>(std::min<cl_ulong>(Device.getInfo<CL_DEVICE_MAX_MEM_ALLOC_SIZE>() / sizeof(float),
+                                                         16 * 1024 * 1024));
+    Size &= ~static_cast<size_t>(1023);
+    double Bytes = static_cast<double>(Size * sizeof(float));
+    std::vector<float> Host(Size, 1.0f);
+
+    if ((Error = Ocl.AllocateBuffer<float>(Size, A)) != CL_SUCCESS ||
+        (Error = Ocl.AllocateBuffer<float>(Size, B)) != CL_SUCCESS ||
+        (Error = Ocl.AllocateBuffer<float>(Size, C)) != CL_SUCCESS ||
+        (Error = Ocl.GetKernelFromProgram(Program, "Copy", Copy)) != CL_SUCCESS ||
+        (Error = Ocl.GetKernelFromProgram(Program, "Scale", Scale)) != CL_SUCCESS ||
+        (Error = Ocl.GetKernelFromProgram(Program, "Add", Add)) != CL_SUCCESS ||
+        (Error = Ocl.GetKernelFromProgram(Program, "Triad", Triad)) != CL_SUCCESS) {
+        return Error;
+    }
+
+    //
+    // Writes also initialize the arrays
+    //
+    Error = GetBestTime(Ocl, Iterations, [&]() { return Ocl.WriteBuffer(A, &Host[0], Size); }, Best);
+    if (Error != CL_SUCCESS) {
+        return Error;
+    }
+    Profile.TransferBandwidth = Bytes / Best;
+
+    if ((Error = Ocl.WriteBuffer(B, &Host[0], Size)) != CL_SUCCESS ||
+        (Error = Ocl.WriteBuffer(C, &Host[0], Size)) != CL_SUCCESS) {
+        return Error;
+    }
+
+    cl::NDRange Global(Size);
+    Error = GetBestTime(Ocl, Iterations, [&]() {
+        return Ocl.ExecuteKernelOnRange(Copy, Global, cl::NullRange, A, C);
+    }, Best);
+    if (Error != CL_SUCCESS) {
+        return Error;
+    }
+    Profile.StreamCopy = 2.0 * Bytes / Best;
+
+    Error = GetBestTime(Ocl, Iterations, [&]() {
+        return Ocl.ExecuteKernelOnRange(Scale, Global, cl::NullRange, B, C, Scalar);
+    }, Best);
+    if (Error != CL_SUCCESS) {
+        return Error;
+    }
+    Profile.StreamScale = 2.0 * Bytes / Best;
+
+    Error = GetBestTime(Ocl, Iterations, [&]() {
+        return Ocl.ExecuteKernelOnRange(Add, Global, cl::NullRange, A, B, C);
+    }, Best);
+    if (Error != CL_SUCCESS) {
+        return Error;
+    }
+    Profile.StreamAdd = 3.0 * Bytes / Best;
+
+    Error = GetBestTime(Ocl, Iterations, [&]() {
+        return Ocl.ExecuteKernelOnRange(Triad, Global, cl::NullRange, A, B, C, Scalar);
+    }, Best);
+    if (Error != CL_SUCCESS) {
+        return Error;
+    }
+    Profile.StreamTriad = 3.0 * Bytes / Best;
+
+    return CL_SUCCESS;
+}
+
+///
+/// \fn     MeasurePeakFlops
+/// \param  Ocl        The OpenCL instance
+/// \param  Iterations Number of measurements
+/// \param  Profile    Profile in which the throughputs are stored
+/// \return CL_SUCCESS or any OpenCL error
+/// \brief  This function measures the floating point throughput per vector width
+///
+static cl_int MeasurePeakFlops(OpenCLWrapper::OpenCL & Ocl, unsigned int Iterations,
+                               OpenCLWrapper::DeviceProfile & Profile) {
+    cl::Device Device;
+    cl::Buffer Out;
+    cl_ulong Best;
+    float Seed = 0.0f;
+
+    cl_int Error = Ocl.GetUsedDevice(Device);
+    if (Error != CL_SUCCESS) {
+        return Error;
+    }
+
+    size_t Size = Device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>() * 4096;
+    Error = Ocl.AllocateBuffer<cl_float>(Size * 16, Out);
+    if (Error != CL_SUCCESS) {
+        return Error;
+    }
+
+    for (unsigned int i = 0; i < MAX_VECTOR_WIDTHS; i++) {
+        unsigned int Width = 1 << i;
+        cl::Kernel Kernel;
+
+        Error = Ocl.GetKernelFromSource(GetPeakKernelSource(Width), "Peak", Kernel);
+        if (Error != CL_SUCCESS) {
+            return Error;
+        }
+
+        Error = GetBestTime(Ocl, Iterations, [&]() {
+            return Ocl.ExecuteKernelOnRange(Kernel, cl::NDRange(Size), cl::NullRange, Out, Seed);
+        }, Best);
+        if (Error != CL_SUCCESS) {
+            return Error;
+        }
+
+        Profile.PeakGflops[i] = static_cast<double>(Size) * PEAK_LOOPS * PEAK_MADS * 2.0 * Width / Best;
+    }
+
+    return CL_SUCCESS;
+}
+
+///
+/// \fn     MeasureAtomics
+/// \param  Ocl        The OpenCL instance
+/// \param  Program    Program with the characterization kernels
+/// \param  Iterations Number of measurements
+/// \param  Profile    Profile in which the throughput is stored
+/// \return CL_SUCCESS or any OpenCL error
+/// \brief  This function measures the throughput of global atomic increments
+/// \details Work-items increment 1024 counters, so that they are contended.
+///
+static cl_int MeasureAtomics(OpenCLWrapper::OpenCL & Ocl, const cl::Program & Program,
+                             unsigned int Iterations, OpenCLWrapper::DeviceProfile & Profile) {
+    const size_t Size = 1024 * 1024;
+    std::vector<cl_int> Host(1024, 0);
+    cl::Buffer Counters;
+    cl::Kernel Kernel;
+    cl_ulong Best;
+
+    cl_int Error = Ocl.AllocateBuffer<cl_int>(Host.size(), Counters);
+    if (Error != CL_SUCCESS) {
+        return Error;
+    }
+
+    Error = Ocl.WriteBuffer(Counters, &Host[0], Host.size());
+    if (Error != CL_SUCCESS) {
+        return Error;
+    }
+
+    Error = Ocl.GetKernelFromProgram(Program, "Atomic", Kernel);
+    if (Error != CL_SUCCESS) {
+        return Error;
+    }
+
+    Error = GetBestTime(Ocl, Iterations, [&]() {
+        return Ocl.ExecuteKernelOnRange(Kernel, cl::NDRange(Size), cl::NullRange, Counters);
+    }, Best);
+    if (Error != CL_SUCCESS) {
+        return Error;
+    }
+
+    Profile.AtomicThroughput = static_cast<double>(Size) * ATOMIC_LOOPS / Best;
+
+    return CL_SUCCESS;
+}
+
+///
+/// \fn     MeasureLocalMemory
+/// \param  Ocl        The OpenCL instance
+/// \param  Program    Program with the characterization kernels
+/// \param  Iterations Number of measurements
+/// \param  Profile    Profile in which the bandwidth is stored
+/// \return CL_SUCCESS or any OpenCL error
+/// \brief  This function measures the bandwidth of local memory reads
+/// \details The work-group size is the largest power of two up to 256 the
+///          kernel supports.
+///
+static cl_int MeasureLocalMemory(OpenCLWrapper::OpenCL & Ocl, const cl::Program & Program,
+                                 unsigned int Iterations, OpenCLWrapper::DeviceProfile & Profile) {
+    cl::Device Device;
+    OpenCLWrapper::KernelResources Resources;
+    cl::Buffer Out;
+    cl::Kernel Kernel;
+    cl_ulong Best;
+
+    cl_int Error = Ocl.GetUsedDevice(Device);
+    if (Error != CL_SUCCESS) {
+        return Error;
+    }
+
+    Error = Ocl.GetKernelFromProgram(Program, "Local", Kernel);
+    if (Error != CL_SUCCESS) {
+        return Error;
+    }
+
+    Error = Ocl.GetKernelResources(Kernel, Resources);
+    if (Error != CL_SUCCESS) {
+        return Error;
+    }
+
+    size_t Group = 256;
+    while (Group > Resources.WorkGroupSize) {
+        Group /= 2;
+    }
+
+    size_t Size = Device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>() * Group * 64;
+    Error = Ocl.AllocateBuffer<float>(Size, Out);
+    if (Error != CL_SUCCESS) {
+        return Error;
+    }
+
+    Error = GetBestTime(Ocl, Iterations, [&]() {
+        return Ocl.ExecuteKernelOnRange(Kernel, cl::NDRange(Size), cl::NDRange(Group),
+                                        Out, cl::Local(Group * sizeof(float)));
+    }, Best);
+    if (Error != CL_SUCCESS) {
+        return Error;
+    }
+
+    Profile.LocalBandwidth = static_cast<double>(Size) * LOCAL_LOOPS * sizeof(float) / Best;
+
+    return CL_SUCCESS;
+}
+
+///
+/// \fn     CharacterizeDevice
+/// \param  Device     The device to characterize
+/// \param  Iterations Number of measurements of each figure
+/// \param  Profile    Measured profile of the device
+/// \return CL_SUCCESS or any OpenCL error
+/// \brief  This function runs all the measurements on a device
+/// \details A failing measurement is reported and left to 0, the other ones
+///          are still run.
+///
+static cl_int CharacterizeDevice(const cl::Device & Device, unsigned int Iterations,
+                                 OpenCLWrapper::DeviceProfile & Profile) {
+    OpenCLWrapper::OpenCL OclObject;
+    cl::Program Program;
+
+    OpenCLWrapper::ClearDeviceProfile(Profile);
+    Profile.Name = Device.getInfo<CL_DEVICE_NAME>();
+    Profile.Vendor = Device.getInfo<CL_DEVICE_VENDOR>();
+    Profile.Driver = Device.getInfo<CL_DRIVER_VERSION>();
+
+    cl_int Error = OclObject.SetUsedDevice(Device);
+    if (Error != CL_SUCCESS) {
+        return Error;
+    }
+
+    OclObject.SetParameter(OpenCLWrapper::ProfilingMode, OpenCLWrapper::ProfilingAlways);
+
+    Error = OclObject.GetProgramFromSource(Kernels, Program);
+    if (Error != CL_SUCCESS) {
+        std::string Log;
+        OclObject.GetLastBuildLog(Log);
+        std::cerr << Profile.Name << ": build failed: " << Error << std::endl << Log;
+        return Error;
+    }
+
+    if ((Error = MeasureLatency(OclObject, Program, Iterations, Profile)) != CL_SUCCESS) {
+        std::cerr << Profile.Name << ": launch latency failed: " << Error << std::endl;
+    }
+
+    if ((Error = MeasureStream(OclObject, Program, Iterations, Profile)) != CL_SUCCESS) {
+        std::cerr << Profile.Name << ": STREAM failed: " << Error << std::endl;
+    }
+
+    if ((Error = MeasurePeakFlops(OclObject, Iterations, Profile)) != CL_SUCCESS) {
+        std::cerr << Profile.Name << ": peak FLOPs failed: " << Error << std::endl;
+    }
+
+    if ((Error = MeasureAtomics(OclObject, Program, Iterations, Profile)) != CL_SUCCESS) {
+        std::cerr << Profile.Name << ": atomics failed: " << Error << std::endl;
+    }
+
+    if ((Error = MeasureLocalMemory(OclObject, Program, Iterations, Profile)) != CL_SUCCESS) {
+        std::cerr << Profile.Name << ": local memory failed: " << Error << std::endl;
+    }
+
+    return CL_SUCCESS;
+}
+
+///
+/// \fn     main
+/// \param  argc Number of passed arguments (>= 1)
+/// \param  argv All the passed arguments
+/// \return 0 in case of success, -error otherwise
+/// \brief  Main function
+///
+int main(int argc, char ** argv) {
+    unsigned int Iterations = 5;
+    std::string Output = "devices.profile";
+    std::vector<OpenCLWrapper::DeviceProfile> Profiles;
+
+    //
+    // Parse the command line
+    //
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
+            Iterations = std::max(atoi(argv[++i]), 1);
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            Output = argv[++i];
+        } else {
+            return PrintUsage(argv[0]);
+        }
+    }
+
+    //
+    // Characterize every usable device of every platform
+    //
+    const std::vector<OpenCLWrapper::DeviceInfo> & Devices = OpenCLWrapper::DeviceRegistry::Get().GetDevices();
+    for (unsigned int i = 0; i < Devices.size(); i++) {
+        if (!Devices[i].Available || !Devices[i].CompilerAvailable) {
+            continue;
+        }
+
+        OpenCLWrapper::DeviceProfile Profile;
+        if (CharacterizeDevice(Devices[i].Device, Iterations, Profile) != CL_SUCCESS) {
+            continue;
+        }
+
+        OpenCLWrapper::DevicePeaks Peaks = OpenCLWrapper::GetProfilePeaks(Profile);
+        std::cout << Profile.Name << ": " << Peaks.ComputeGflops << " GFLOP/s, "
+                  << Peaks.MemoryBandwidth << " GB/s, " << Profile.LaunchLatency
+                  << " ns launch" << std::endl;
+        Profiles.push_back(Profile);
+    }
+
+    if (Profiles.empty()) {
+        std::cerr << "No OpenCL device could be characterized" << std::endl;
+        return -1;
+    }
+
+    std::ofstream File(Output.c_str());
+    if (!File.is_open() || OpenCLWrapper::SaveDeviceProfiles(File, Profiles) != CL_SUCCESS) {
+        std::cerr << "Could not write: " << Output << std::endl;
+        return -2;
+    }
+
+    return 0;
+}
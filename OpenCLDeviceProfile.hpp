@@ -0,0 +1,224 @@
+///
+/// \file    OpenCLDeviceProfile.hpp
+/// \brief   Measured characteristics of OpenCL devices
+/// \details This file provides the profile filled by a characterization
+///          run of a device and the functions to persist it. The format is
+///          a plain text file with a [device] section per device followed
+///          by "key = value" lines.
+/// \date    17-10-2026
+///
+
+#ifndef OPENCLWRAPPER_DEVICE_PROFILE_HPP
+#define OPENCLWRAPPER_DEVICE_PROFILE_HPP
+
+#include <CL/cl.hpp>
+#include "OpenCLProfiling.hpp"
+#include <cstdlib>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace OpenCLWrapper {
+
+///
+/// \def     MAX_VECTOR_WIDTHS
+/// \brief   Number of vector widths measured: 1, 2, 4, 8 and 16
+///
+#define MAX_VECTOR_WIDTHS 5
+
+///
+/// \struct  DeviceProfile
+/// \brief   Measured characteristics of a device
+/// \details Any figure left to 0 wasn't measured.
+///
+struct DeviceProfile {
+    /// Name of the device, as reported by CL_DEVICE_NAME
+    std::string Name;
+    /// Vendor of the device
+    std::string Vendor;
+    /// Version of the driver
+    std::string Driver;
+    /// Round-trip latency of an empty kernel, in ns
+    double      LaunchLatency;
+    /// STREAM copy bandwidth in GB/s
+    double      StreamCopy;
+    /// STREAM scale bandwidth in GB/s
+    double      StreamScale;
+    /// STREAM add bandwidth in GB/s
+    double      StreamAdd;
+    /// STREAM triad bandwidth in GB/s
+    double      StreamTriad;
+    /// Floating point throughput in GFLOP/s, per vector width (1 << index)
+    double      PeakGflops[MAX_VECTOR_WIDTHS];
+    /// Global atomic throughput in Gop/s
+    double      AtomicThroughput;
+    /// Local memory bandwidth in GB/s
+    double      LocalBandwidth;
+    /// Host/device transfer bandwidth in GB/s
+    double      TransferBandwidth;
+};
+
+///
+/// \fn      ClearDeviceProfile
+/// \param   Profile Profile to reset
+/// \brief   This function resets a profile so that nothing is measured
+///
+inline void ClearDeviceProfile(DeviceProfile & Profile) {
+    Profile.Name.clear();
+    Profile.Vendor.clear();
+    Profile.Driver.clear();
+    Profile.LaunchLatency = 0.0;
+    Profile.StreamCopy = 0.0;
+    Profile.StreamScale = 0.0;
+    Profile.StreamAdd = 0.0;
+    Profile.StreamTriad = 0.0;
+    for (unsigned int i = 0; i < MAX_VECTOR_WIDTHS; i++) {
+        Profile.PeakGflops[i] = 0.0;
+    }
+    Profile.AtomicThroughput = 0.0;
+    Profile.LocalBandwidth = 0.0;
+    Profile.TransferBandwidth = 0.0;
+}
+
+///
+/// \fn      GetProfilePeaks
+/// \param   Profile Measured profile of the device
+/// \return  The peak figures of the device
+/// \brief   This function derives the peak figures of a device from its profile
+/// \details The compute peak is the best vector width and the memory peak is
+///          the best STREAM kernel.
+///
+inline DevicePeaks GetProfilePeaks(const DeviceProfile & Profile) {
+    DevicePeaks Peaks;
+
+    Peaks.ComputeGflops = *std::max_element(Profile.PeakGflops,
+                                            Profile.PeakGflops + MAX_VECTOR_WIDTHS);
+    Peaks.MemoryBandwidth = std::max(std::max(Profile.StreamCopy, Profile.StreamScale),
+                                     std::max(Profile.StreamAdd, Profile.StreamTriad));
+    Peaks.TransferBandwidth = Profile.TransferBandwidth;
+
+    return Peaks;
+}
+
+///
+/// \fn      SaveDeviceProfiles
+/// \param   Stream   The stream in which profiles are written
+/// \param   Profiles Profiles to write
+/// \return  CL_SUCCESS, CL_INVALID_VALUE if the stream failed
+/// \brief   This function writes device profiles
+///
+inline cl_int SaveDeviceProfiles(std::ostream & Stream,
+                                 const std::vector<DeviceProfile> & Profiles) {
+    for (size_t i = 0; i < Profiles.size(); i++) {
+        const DeviceProfile & Profile = Profiles[i];
+
+        Stream << "[device]\n"
+               << "name = " << Profile.Name << "\n"
+               << "vendor = " << Profile.Vendor << "\n"
+               << "driver = " << Profile.Driver << "\n"
+               << "launch_latency_ns = " << Profile.LaunchLatency << "\n"
+               << "stream_copy_gbs = " << Profile.StreamCopy << "\n"
+               << "stream_scale_gbs = " << Profile.StreamScale << "\n"
+               << "stream_add_gbs = " << Profile.StreamAdd << "\n"
+               << "stream_triad_gbs = " << Profile.StreamTriad << "\n";
+        for (unsigned int j = 0; j < MAX_VECTOR_WIDTHS; j++) {
+            Stream << "peak_gflops_" << (1 << j) << " = " << Profile.PeakGflops[j] << "\n";
+        }
+        Stream << "atomic_gops = " << Profile.AtomicThroughput << "\n"
+               << "local_bandwidth_gbs = " << Profile.LocalBandwidth << "\n"
+               << "transfer_bandwidth_gbs = " << Profile.TransferBandwidth << "\n\n";
+    }
+
+    return (Stream.good() ? CL_SUCCESS : CL_INVALID_VALUE);
+}
+
+///
+/// \fn      LoadDeviceProfiles
+/// \param   Stream   The stream from which profiles are read
+/// \param   Profiles Read profiles
+/// \return  CL_SUCCESS, CL_INVALID_VALUE if a line is malformed
+/// \brief   This function reads device profiles written by SaveDeviceProfiles()
+/// \details Blank lines, lines starting with '#' and unknown keys are
+///          ignored, so that files can be annotated.
+///
+inline cl_int LoadDeviceProfiles(std::istream & Stream,
+                                 std::vector<DeviceProfile> & Profiles) {
+    std::string Line;
+
+    Profiles.clear();
+    while (std::getline(Stream, Line)) {
+        if (Line.empty() || Line[0] == '#') {
+            continue;
+        }
+
+        if (Line.compare("[device]") == 0) {
+            Profiles.push_back(DeviceProfile());
+            ClearDeviceProfile(Profiles.back());
+            continue;
+        }
+
+        size_t Separator = Line.find(" = ");
+        if (Separator == std::string::npos || Profiles.empty()) {
+            return CL_INVALID_VALUE;
+        }
+
+        DeviceProfile & Profile = Profiles.back();
+        std::string Key = Line.substr(0, Separator);
+        std::string Value = Line.substr(Separator + 3);
+        double Number = atof(Value.c_str());
+
+        if (Key.compare("name") == 0) {
+            Profile.Name = Value;
+        } else if (Key.compare("vendor") == 0) {
+            Profile.Vendor = Value;
+        } else if (Key.compare("driver") == 0) {
+            Profile.Driver = Value;
+        } else if (Key.compare("launch_latency_ns") == 0) {
+            Profile.LaunchLatency = Number;
+        } else if (Key.compare("stream_copy_gbs") == 0) {
+            Profile.StreamCopy = Number;
+        } else if (Key.compare("stream_scale_gbs") == 0) {
+            Profile.StreamScale = Number;
+        } else if (Key.compare("stream_add_gbs") == 0) {
+            Profile.StreamAdd = Number;
+        } else if (Key.compare("stream_triad_gbs") == 0) {
+            Profile.StreamTriad = Number;
+        } else if (Key.compare(0, 12, "peak_gflops_") == 0) {
+            int Width = atoi(Key.c_str() + 12);
+            for (unsigned int i = 0; i < MAX_VECTOR_WIDTHS; i++) {
+                if (Width == (1 << i)) {
+                    Profile.PeakGflops[i] = Number;
+                }
+            }
+        } else if (Key.compare("atomic_gops") == 0) {
+            Profile.AtomicThroughput = Number;
+        } else if (Key.compare("local_bandwidth_gbs") == 0) {
+            Profile.LocalBandwidth = Number;
+        } else if (Key.compare("transfer_bandwidth_gbs") == 0) {
+            Profile.TransferBandwidth = Number;
+        }
+    }
+
+    return CL_SUCCESS;
+}
+
+///
+/// \fn      FindDeviceProfile
+/// \param   Profiles Known profiles
+/// \param   Name     Name of the device, as reported by CL_DEVICE_NAME
+/// \return  The profile of the device, 0 if there is none
+///
+inline const DeviceProfile * FindDeviceProfile(const std::vector<DeviceProfile> & Profiles,
+                                               const std::string & Name) {
+    for (size_t i = 0; i < Profiles.size(); i++) {
+        if (Profiles[i].Name == Name) {
+            return &Profiles[i];
+        }
+    }
+
+    return 0;
+}
+}
+
+#endif
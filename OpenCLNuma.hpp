@@ -0,0 +1,171 @@
+///
+/// \file    OpenCLNuma.hpp
+/// \brief   NUMA-aware allocation of host memory
+/// \details This file provides the allocation of the host memory backing
+///          buffers created with CL_MEM_USE_HOST_PTR, so that CPU devices
+///          read it from the NUMA node of the cores running the kernels.
+///          NUMA placement requires libnuma and is only built in when
+///          OPENCLWRAPPER_USE_NUMA is defined. Otherwise, the memory is
+///          only page aligned and placed by the system.
+/// \date    17-10-2026
+///
+
+#ifndef OPENCLWRAPPER_NUMA_HPP
+#define OPENCLWRAPPER_NUMA_HPP
+
+#include <CL/cl.hpp>
+#include <cstdlib>
+#include <new>
+#ifdef OPENCLWRAPPER_USE_NUMA
+#include <numa.h>
+#endif
+
+namespace OpenCLWrapper {
+
+///
+/// \def     HOST_MEMORY_ALIGNMENT
+/// \brief   Alignment of the host memory, so that CPU devices don't copy it
+///
+#define HOST_MEMORY_ALIGNMENT 4096
+
+///
+/// \enum    NumaPolicies
+/// \brief   Enumeration for all the supported host memory placements
+/// \details Those policies can be set using SetParameter() with NumaPolicy
+///
+enum NumaPolicies {
+    NumaOff,         ///< The memory is placed by the system
+    NumaLocal,       ///< The memory is placed on the node of the thread allocating it
+    NumaInterleaved, ///< The memory pages are interleaved over all the nodes
+    NumaExplicit,    ///< The memory is placed on the node set with NumaNode
+    MaxNumaPolicies  ///< NUMA policy cannot be higher
+};
+
+///
+/// \struct  HostMemory
+/// \brief   Host memory allocated with AllocateHostMemory()
+///
+struct HostMemory {
+    /// Start of the memory
+    void * Pointer;
+    /// Size of the memory, in bytes
+    size_t Size;
+    /// Whether the memory was allocated by libnuma
+    bool   Numa;
+};
+
+///
+/// \fn      IsNumaAvailable
+/// \return  true if the memory can be placed on NUMA nodes, false otherwise
+///
+inline bool IsNumaAvailable() {
+#ifdef OPENCLWRAPPER_USE_NUMA
+    return (numa_available() != -1);
+#else
+    return false;
+#endif
+}
+
+///
+/// \fn      GetNumaNodes
+/// \return  The number of NUMA nodes, 1 if NUMA isn't available
+///
+inline int GetNumaNodes() {
+#ifdef OPENCLWRAPPER_USE_NUMA
+    if (IsNumaAvailable()) {
+        return numa_num_configured_nodes();
+    }
+#endif
+    return 1;
+}
+
+///
+/// \fn      AllocateHostMemory
+/// \param   Size   Size of the memory, in bytes
+/// \param   Policy Placement of the memory, see NumaPolicies
+/// \param   Node   NUMA node of the memory, -1 for the node of the calling thread
+/// \param   Memory The allocated memory
+/// \return  CL_SUCCESS, CL_OUT_OF_HOST_MEMORY, CL_INVALID_VALUE, CL_INVALID_OPERATION
+/// \brief   This function allocates page aligned host memory on NUMA nodes
+/// \details NumaLocal and NumaExplicit place the memory on Node.
+///          CL_INVALID_OPERATION is returned if a policy other than NumaOff
+///          is requested while NUMA isn't available, and CL_INVALID_VALUE if
+///          Node doesn't exist.
+///
+inline cl_int AllocateHostMemory(size_t Size, unsigned long Policy, int Node, HostMemory & Memory) {
+    Memory.Pointer = 0;
+    Memory.Size = Size;
+    Memory.Numa = false;
+
+    if (Size == 0) {
+        return CL_INVALID_VALUE;
+    }
+
+    if (Policy != NumaOff && !IsNumaAvailable()) {
+        return CL_INVALID_OPERATION;
+    }
+
+#ifdef OPENCLWRAPPER_USE_NUMA
+    if (Policy != NumaOff) {
+        if (Node > numa_max_node()) {
+            return CL_INVALID_VALUE;
+        }
+
+        if (Policy == NumaInterleaved) {
+            Memory.Pointer = numa_alloc_interleaved(Size);
+        } else if (Node < 0) {
+            Memory.Pointer = numa_alloc_local(Size);
+        } else {
+            Memory.Pointer = numa_alloc_onnode(Size, Node);
+        }
+
+        Memory.Numa = true;
+
+        return (Memory.Pointer == 0 ? CL_OUT_OF_HOST_MEMORY : CL_SUCCESS);
+    }
+#else
+    (void)Node;
+#endif
+
+    if (posix_memalign(&Memory.Pointer, HOST_MEMORY_ALIGNMENT, Size) != 0) {
+        Memory.Pointer = 0;
+        return CL_OUT_OF_HOST_MEMORY;
+    }
+
+    return CL_SUCCESS;
+}
+
+///
+/// \fn      FreeHostMemory
+/// \param   Memory Memory allocated with AllocateHostMemory()
+///
+inline void FreeHostMemory(HostMemory & Memory) {
+#ifdef OPENCLWRAPPER_USE_NUMA
+    if (Memory.Numa) {
+        numa_free(Memory.Pointer, Memory.Size);
+        Memory.Pointer = 0;
+        return;
+    }
+#endif
+
+    free(Memory.Pointer);
+    Memory.Pointer = 0;
+}
+
+///
+/// \fn      ReleaseHostMemory
+/// \param   Buffer The buffer being released
+/// \param   Data   Memory backing the buffer, allocated with new
+/// \brief   Destructor callback of the buffers backed by host memory
+///
+inline void CL_CALLBACK ReleaseHostMemory(cl_mem Buffer, void * Data) {
+    HostMemory * Memory = static_cast<HostMemory *>(Data);
+
+    (void)Buffer;
+
+    FreeHostMemory(*Memory);
+    delete Memory;
+}
+}
+
+#endif
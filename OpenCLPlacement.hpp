@@ -0,0 +1,291 @@
+///
+/// \file    OpenCLPlacement.hpp
+/// \brief   Profile-guided placement of kernels on devices
+/// \details This file provides the tracker that times the invocations of
+///          each kernel on every device of a context and routes the next
+///          invocations to the device with the lowest measured latency.
+/// \date    17-10-2026
+///
+
+#ifndef OPENCLWRAPPER_PLACEMENT_HPP
+#define OPENCLWRAPPER_PLACEMENT_HPP
+
+#include <CL/cl.hpp>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace OpenCLWrapper {
+
+///
+/// \struct  KernelPlacement
+/// \brief   Placement state of a kernel
+///
+struct KernelPlacement {
+    /// Name of the kernel
+    std::string           Name;
+    /// Number of invocations placed so far
+    unsigned long         Invocations;
+    /// Device the next invocation would run on, without probing
+    unsigned int          Device;
+    /// Number of timed invocations per device
+    std::vector<cl_ulong> Samples;
+    /// Smoothed latency per device in ns, transfers included, 0 if not timed yet
+    std::vector<double>   Latency;
+};
+
+///
+/// \class   PlacementTracker
+/// \brief   Times kernels on every device and selects the fastest one
+/// \details The latency of an invocation is its execution time, from its
+///          start to its end, so that waiting behind other commands isn't
+///          charged to the device. The cost of moving its buffers to the
+///          device, given when the invocation is tracked, is added to it.
+///          Each kernel is first probed a few times on every device. Then,
+///          it runs on the device with the lowest smoothed latency, except for one invocation every
+///          interval, that probes the other devices in turn so that changes
+///          are caught. Invocations are timed once they are done, without
+///          ever waiting for them.
+///
+class PlacementTracker {
+private:
+    ///
+    /// \struct  PendingInvocation
+    /// \brief   Invocation queued but not timed yet
+    ///
+    struct PendingInvocation {
+        /// Name of the kernel
+        std::string  Name;
+        /// Device on which the kernel was queued
+        unsigned int Device;
+        /// Event of the invocation, from a queue with profiling enabled
+        cl::Event    Event;
+        /// Cost of the transfers of the invocation, in ns
+        cl_ulong     Transfer;
+    };
+
+    /// Number of devices the kernels are placed on
+    unsigned int                           mDevices;
+    /// Number of probes per device before placing
+    unsigned long                          mProbes;
+    /// 1 invocation in mInterval probes another device, 0 to never probe again
+    unsigned long                          mInterval;
+    /// Weight of the last sample in the smoothed latency
+    double                                 mSmoothing;
+    /// State of all the placed kernels
+    std::map<std::string, KernelPlacement> mKernels;
+    /// Number of invocations queued per kernel and device, timed or not
+    std::map<std::string, std::vector<cl_ulong> > mIssued;
+    /// Invocations not timed yet, oldest first
+    std::deque<PendingInvocation>          mPending;
+    /// Maximum number of invocations waiting to be timed
+    size_t                                 mMaxPending;
+
+    ///
+    /// \fn      GetKernel
+    /// \param   Name Name of the kernel
+    /// \return  The state of the kernel, created if needed
+    ///
+    KernelPlacement & GetKernel(const std::string & Name) {
+        std::map<std::string, KernelPlacement>::iterator it = mKernels.find(Name);
+        if (it == mKernels.end()) {
+            KernelPlacement Kernel;
+            Kernel.Name = Name;
+            Kernel.Invocations = 0;
+            Kernel.Device = 0;
+            Kernel.Samples.assign(mDevices, 0);
+            Kernel.Latency.assign(mDevices, 0.0);
+
+            it = mKernels.insert(std::make_pair(Name, Kernel)).first;
+            mIssued[Name].assign(mDevices, 0);
+        }
+
+        return it->second;
+    }
+
+    ///
+    /// \fn      Update
+    /// \param   Name    Name of the kernel
+    /// \param   Device  Device on which the kernel ran
+    /// \param   Latency Latency of the invocation in ns, transfers included
+    /// \brief   This function accounts a timed invocation
+    ///
+    void Update(const std::string & Name, unsigned int Device, cl_ulong Latency) {
+        KernelPlacement & Kernel = GetKernel(Name);
+
+        if (Kernel.Samples[Device] == 0) {
+            Kernel.Latency[Device] = static_cast<double>(Latency);
+        } else {
+            Kernel.Latency[Device] = mSmoothing * Latency + (1.0 - mSmoothing) * Kernel.Latency[Device];
+        }
+        Kernel.Samples[Device]++;
+
+        //
+        // Keep the best timed device up to date
+        //
+        for (unsigned int i = 0; i < mDevices; i++) {
+            if (Kernel.Samples[i] != 0 &&
+                (Kernel.Samples[Kernel.Device] == 0 || Kernel.Latency[i] < Kernel.Latency[Kernel.Device])) {
+                Kernel.Device = i;
+            }
+        }
+    }
+
+public:
+    ///
+    /// \fn      PlacementTracker
+    /// \brief   Constructor that simply initializes a tracker without device
+    /// \details By default, kernels are probed 3 times on each device and 1
+    ///          invocation in 100 probes another device.
+    ///
+    PlacementTracker() {
+        mDevices = 0;
+        mProbes = 3;
+        mInterval = 100;
+        mSmoothing = 0.25;
+        mMaxPending = 256;
+    }
+
+    ///
+    /// \fn      Reset
+    /// \param   Devices Number of devices the kernels are placed on
+    /// \brief   This function drops the state of all the kernels
+    ///
+    void Reset(unsigned int Devices) {
+        mDevices = Devices;
+        mKernels.clear();
+        mIssued.clear();
+        mPending.clear();
+    }
+
+    ///
+    /// \fn      SetProbes
+    /// \param   Probes Number of probes per device before placing
+    /// \return  CL_SUCCESS, CL_INVALID_VALUE
+    ///
+    cl_int SetProbes(unsigned long Probes) {
+        if (Probes == 0) {
+            return CL_INVALID_VALUE;
+        }
+
+        mProbes = Probes;
+
+        return CL_SUCCESS;
+    }
+
+    ///
+    /// \fn      SetInterval
+    /// \param   Interval 1 invocation in Interval probes another device, 0 to never probe again
+    ///
+    void SetInterval(unsigned long Interval) {
+        mInterval = Interval;
+    }
+
+    ///
+    /// \fn      Poll
+    /// \brief   This function times all the invocations that are done
+    /// \details Invocations are polled oldest first and polling stops at the
+    ///          first one that isn't done. Failed invocations are dropped.
+    ///
+    void Poll() {
+        while (!mPending.empty()) {
+            PendingInvocation & Pending = mPending.front();
+            cl_int Error;
+
+            cl_int Status = Pending.Event.getInfo<CL_EVENT_COMMAND_EXECUTION_STATUS>(&Error);
+            if (Error == CL_SUCCESS && Status > CL_COMPLETE) {
+                break;
+            }
+
+            cl_ulong Start, End;
+            if (Error == CL_SUCCESS && Status == CL_COMPLETE &&
+                Pending.Event.getProfilingInfo(CL_PROFILING_COMMAND_START, &Start) == CL_SUCCESS &&
+                Pending.Event.getProfilingInfo(CL_PROFILING_COMMAND_END, &End) == CL_SUCCESS) {
+                Update(Pending.Name, Pending.Device, (End > Start ? End - Start : 0) + Pending.Transfer);
+            }
+
+            mPending.pop_front();
+        }
+    }
+
+    ///
+    /// \fn      Select
+    /// \param   Name Name of the kernel about to be queued
+    /// \return  The device on which the kernel has to be queued
+    /// \brief   This function places the next invocation of a kernel
+    ///
+    unsigned int Select(const std::string & Name) {
+        Poll();
+
+        KernelPlacement & Kernel = GetKernel(Name);
+        std::vector<cl_ulong> & Issued = mIssued[Name];
+        unsigned long Invocation = Kernel.Invocations++;
+
+        //
+        // Probe the devices that weren't timed enough, fewest probes first
+        //
+        unsigned int Device = 0;
+        for (unsigned int i = 1; i < mDevices; i++) {
+            if (Issued[i] < Issued[Device]) {
+                Device = i;
+            }
+        }
+
+        if (Issued[Device] >= mProbes) {
+            Device = Kernel.Device;
+
+            //
+            // Periodically, probe the other devices in turn
+            //
+            if (mInterval != 0 && mDevices > 1 && Invocation % mInterval == 0) {
+                Device = (Kernel.Device + 1 + (Invocation / mInterval) % (mDevices - 1)) % mDevices;
+            }
+        }
+
+        Issued[Device]++;
+
+        return Device;
+    }
+
+    ///
+    /// \fn      Track
+    /// \param   Name     Name of the kernel
+    /// \param   Device   Device on which the kernel was queued
+    /// \param   Event    Event of the invocation
+    /// \param   Transfer Cost of moving the buffers of the invocation to the device, in ns
+    /// \brief   This function keeps an invocation to time it once done
+    /// \details If too many invocations are waiting, the oldest is dropped.
+    ///
+    void Track(const std::string & Name, unsigned int Device, const cl::Event & Event,
+               cl_ulong Transfer) {
+        PendingInvocation Pending;
+        Pending.Name = Name;
+        Pending.Device = Device;
+        Pending.Event = Event;
+        Pending.Transfer = Transfer;
+
+        if (mPending.size() >= mMaxPending) {
+            mPending.pop_front();
+        }
+        mPending.push_back(Pending);
+    }
+
+    ///
+    /// \fn      GetPlacements
+    /// \param   Placements Placement state of all the kernels
+    /// \brief   This function returns the placement state of all the kernels
+    ///
+    void GetPlacements(std::vector<KernelPlacement> & Placements) {
+        Poll();
+
+        Placements.clear();
+        for (std::map<std::string, KernelPlacement>::const_iterator it = mKernels.begin();
+             it != mKernels.end(); ++it) {
+            Placements.push_back(it->second);
+        }
+    }
+};
+}
+
+#endif
@@ -0,0 +1,1514 @@
+///
+/// \file    OpenCLProfiling.hpp
+/// \brief   Profiling helpers used by the OpenCL wrapper
+/// \details This file provides the recorder that keeps track of all the
+///          commands queued by the wrapper so that their timeline can be
+///          queried or exported after they completed, the statistics
+///          aggregated per kernel and per transfer direction, the
+///          telemetry of program builds and their export as metrics.
+/// \date    17-10-2026
+///
+
+#ifndef OPENCLWRAPPER_PROFILING_HPP
+#define OPENCLWRAPPER_PROFILING_HPP
+
+#include <CL/cl.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace OpenCLWrapper {
+
+///
+/// \enum    CommandTypes
+/// \brief   Enumeration for all the commands the wrapper can queue
+///
+enum CommandTypes {
+    KernelCommand, ///< Execution of a kernel
+    ReadCommand,   ///< Read of a device buffer into host memory
+    WriteCommand,  ///< Write of host memory into a device buffer
+    MaxCommands    ///< Command type cannot be higher
+};
+
+///
+/// \fn      GetHostTime
+/// \return  The current host time in ns
+/// \brief   This function returns a monotonic host timestamp
+///
+inline cl_ulong GetHostTime() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+///
+/// \fn      EscapeJson
+/// \param   Value The string to escape
+/// \return  The escaped string
+/// \brief   This function escapes a string so that it can be put in JSON
+///
+inline std::string EscapeJson(const std::string & Value) {
+    std::string Escaped;
+
+    for (size_t i = 0; i < Value.length(); i++) {
+        unsigned char Char = Value[i];
+        if (Char == '"' || Char == '\\') {
+            Escaped += '\\';
+            Escaped += Char;
+        } else if (Char < 0x20) {
+            static const char Hex[] = "0123456789abcdef";
+            Escaped += "\\u00";
+            Escaped += Hex[Char >> 4];
+            Escaped += Hex[Char & 0xF];
+        } else {
+            Escaped += Char;
+        }
+    }
+
+    return Escaped;
+}
+
+///
+/// \struct  KernelWorkload
+/// \brief   Amount of work declared by the user for a kernel launch
+///
+struct KernelWorkload {
+    /// Number of floating point operations done by the launch
+    cl_ulong Flops;
+    /// Number of bytes read and written by the launch in global memory
+    cl_ulong Bytes;
+};
+
+///
+/// \fn      GetArgumentBytes
+/// \tparam  T   Type of the kernel argument
+/// \param   Arg Kernel argument
+/// \return  0, only buffers account for global memory traffic
+///
+template<typename T>
+cl_ulong GetArgumentBytes(const T & Arg) {
+    (void)Arg;
+    return 0;
+}
+
+///
+/// \fn      GetArgumentBytes
+/// \param   Arg Buffer passed as kernel argument
+/// \return  The size of the buffer
+/// \brief   This function counts the bytes a buffer argument brings to a launch
+/// \details This assumes the buffer is entirely read or written once, which
+///          is the compulsory traffic of most streaming kernels.
+///
+inline cl_ulong GetArgumentBytes(const cl::Buffer & Arg) {
+    return Arg.getInfo<CL_MEM_SIZE>();
+}
+
+///
+/// \struct  DevicePeaks
+/// \brief   Peak figures of a device
+/// \details A figure set to 0 is unknown and won't be used for comparison.
+///
+struct DevicePeaks {
+    /// Peak floating point throughput in GFLOP/s
+    double ComputeGflops;
+    /// Peak global memory bandwidth in GB/s
+    double MemoryBandwidth;
+    /// Peak host/device transfer bandwidth in GB/s
+    double TransferBandwidth;
+};
+
+///
+/// \struct  ThroughputReport
+/// \brief   Achieved throughput of a command compared to the device peaks
+///
+struct ThroughputReport {
+    /// Sequence number of the command
+    unsigned long Sequence;
+    /// Type of the command
+    CommandTypes  Type;
+    /// Name of the kernel for kernel commands, empty otherwise
+    std::string   Name;
+    /// Device time of the command in ns
+    cl_ulong      Duration;
+    /// Achieved bandwidth in GB/s, 0 if no byte was declared nor counted
+    double        Bandwidth;
+    /// Achieved throughput in GFLOP/s, 0 if no operation was declared
+    double        Gflops;
+    /// Ratio of the achieved bandwidth to the peak one, 0 if unknown
+    double        BandwidthRatio;
+    /// Ratio of the achieved throughput to the peak one, 0 if unknown
+    double        GflopsRatio;
+};
+
+///
+/// \struct  CommandRecord
+/// \brief   Profiling information of a single queued command
+/// \details All the timestamps are expressed in ns, as returned by the
+///          OpenCL implementation. They are only meaningful if Status is
+///          CL_SUCCESS.
+///
+struct CommandRecord {
+    /// Sequence number of the command, starting from 0
+    unsigned long Sequence;
+    /// Type of the command
+    CommandTypes  Type;
+    /// Name of the kernel for kernel commands, empty otherwise
+    std::string   Name;
+    /// Number of bytes transferred by read and write commands, or declared or counted for kernels
+    cl_ulong      Bytes;
+    /// Number of floating point operations declared for kernels
+    cl_ulong      Flops;
+    /// Number of work-items used for kernel commands
+    cl::NDRange   GlobalSize;
+    /// Number of work-items per work-group used for kernel commands
+    cl::NDRange   LocalSize;
+    /// Index of the queue on which the command was queued
+    unsigned int  Queue;
+    /// Host time at which the wrapper started queuing the command
+    cl_ulong      HostBegin;
+    /// Host time at which the wrapper was done queuing the command
+    cl_ulong      HostEnd;
+    /// Time at which the command was queued by the host
+    cl_ulong      Queued;
+    /// Time at which the command was submitted to the device
+    cl_ulong      Submit;
+    /// Time at which the command started on the device
+    cl_ulong      Start;
+    /// Time at which the command ended on the device
+    cl_ulong      End;
+    /// Result of the profiling information query
+    cl_int        Status;
+    /// Whether the timestamps were already queried
+    bool          Resolved;
+    /// Event associated with the command, released once resolved
+    cl::Event     Event;
+};
+
+///
+/// \struct  BuildRecord
+/// \brief   Telemetry of a program creation and build
+/// \details All the times are host wall times expressed in ns.
+///
+struct BuildRecord {
+    /// Length of the program source code
+    size_t      SourceSize;
+    /// Options used for the build
+    std::string Options;
+    /// Name of the device the program was built for
+    std::string Device;
+    /// Whether the program was found in the cache, in which case it wasn't built
+    bool        CacheHit;
+    /// Time spent creating the program
+    cl_ulong    CreateTime;
+    /// Time spent building the program
+    cl_ulong    BuildTime;
+    /// Result of the creation and build
+    cl_int      Status;
+    /// Build log, if the build failed or produced warnings
+    std::string Log;
+};
+
+///
+/// \class   LatencyHistogram
+/// \brief   Histogram of latencies with a bounded memory footprint
+/// \details Values are stored in log-linear buckets, as HDR histograms do:
+///          each power of two is split in SubBuckets linear buckets, which
+///          bounds the relative error of any percentile to 1 / SubBuckets.
+///          Values below 2 * SubBuckets ns are exact, values above 2^MaxBits
+///          ns are saturated.
+///
+class LatencyHistogram {
+public:
+    /// Number of bits used for the linear sub-buckets
+    static const unsigned int SubBucketBits = 5;
+    /// Number of linear sub-buckets per power of two
+    static const unsigned int SubBuckets = 1 << SubBucketBits;
+    /// Number of bits of the highest value that can be stored
+    static const unsigned int MaxBits = 48;
+    /// Total number of buckets
+    static const unsigned int Buckets = (MaxBits - SubBucketBits + 1) * SubBuckets;
+
+private:
+    /// Number of values in each bucket
+    std::vector<cl_ulong> mCounts;
+    /// Number of values stored
+    cl_ulong              mCount;
+    /// Sum of all the values stored
+    cl_ulong              mTotal;
+    /// Lowest value stored
+    cl_ulong              mMin;
+    /// Highest value stored
+    cl_ulong              mMax;
+
+public:
+    ///
+    /// \fn      LatencyHistogram
+    /// \brief   Constructor that simply initializes an empty histogram
+    ///
+    LatencyHistogram() : mCounts(Buckets, 0) {
+        mCount = 0;
+        mTotal = 0;
+        mMin = 0;
+        mMax = 0;
+    }
+
+    ///
+    /// \fn      GetBucket
+    /// \param   Value The value for which the bucket is looked for
+    /// \return  The index of the bucket holding the value
+    /// \brief   This function computes the bucket in which a value is stored
+    ///
+    static unsigned int GetBucket(cl_ulong Value) {
+        if (Value >= (static_cast<cl_ulong>(1) << MaxBits)) {
+            Value = (static_cast<cl_ulong>(1) << MaxBits) - 1;
+        }
+
+        if (Value < 2 * SubBuckets) {
+            return static_cast<unsigned int>(Value);
+        }
+
+        unsigned int Shift = 0;
+        while ((Value >> Shift) >= 2 * SubBuckets) {
+            Shift++;
+        }
+
+        return (Shift + 1) * SubBuckets + static_cast<unsigned int>(Value >> Shift) - SubBuckets;
+    }
+
+    ///
+    /// \fn      GetBucketValue
+    /// \param   Bucket The index of the bucket
+    /// \return  The value representing the bucket
+    /// \brief   This function returns the middle of the range held by a bucket
+    ///
+    static cl_ulong GetBucketValue(unsigned int Bucket) {
+        if (Bucket < 2 * SubBuckets) {
+            return Bucket;
+        }
+
+        unsigned int Shift = Bucket / SubBuckets - 1;
+        cl_ulong Lowest = static_cast<cl_ulong>(SubBuckets + Bucket % SubBuckets) << Shift;
+
+        return Lowest + ((static_cast<cl_ulong>(1) << Shift) >> 1);
+    }
+
+    ///
+    /// \fn      GetBucketLimit
+    /// \param   Bucket The index of the bucket
+    /// \return  The highest value held by a bucket
+    /// \brief   This function returns the upper bound of the range held by a bucket
+    ///
+    static cl_ulong GetBucketLimit(unsigned int Bucket) {
+        if (Bucket < 2 * SubBuckets) {
+            return Bucket;
+        }
+
+        unsigned int Shift = Bucket / SubBuckets - 1;
+        cl_ulong Lowest = static_cast<cl_ulong>(SubBuckets + Bucket % SubBuckets) << Shift;
+
+        return Lowest + (static_cast<cl_ulong>(1) << Shift) - 1;
+    }
+
+    ///
+    /// \fn      Add
+    /// \param   Value The value to store, in ns
+    /// \brief   This function stores a value in the histogram
+    ///
+    void Add(cl_ulong Value) {
+        mCounts[GetBucket(Value)]++;
+        mMin = (mCount == 0 ? Value : std::min(mMin, Value));
+        mMax = (mCount == 0 ? Value : std::max(mMax, Value));
+        mCount++;
+        mTotal += Value;
+    }
+
+    ///
+    /// \fn      GetPercentile
+    /// \param   Percentile The percentile to compute, between 0 and 100
+    /// \return  The value at the given percentile, 0 if empty
+    /// \brief   This function computes a percentile of the stored values
+    ///
+    cl_ulong GetPercentile(double Percentile) const {
+        if (mCount == 0) {
+            return 0;
+        }
+
+        cl_ulong Target = static_cast<cl_ulong>(Percentile / 100.0 * mCount + 0.5);
+        Target = std::max(static_cast<cl_ulong>(1), std::min(Target, mCount));
+
+        cl_ulong Seen = 0;
+        for (unsigned int i = 0; i < Buckets; i++) {
+            Seen += mCounts[i];
+            if (Seen >= Target) {
+                return std::max(mMin, std::min(mMax, GetBucketValue(i)));
+            }
+        }
+
+        return mMax;
+    }
+
+    ///
+    /// \fn      GetBucketCount
+    /// \param   Bucket The index of the bucket
+    /// \return  The number of values held by the bucket
+    ///
+    cl_ulong GetBucketCount(unsigned int Bucket) const {
+        return mCounts[Bucket];
+    }
+
+    ///
+    /// \fn      GetCount
+    /// \return  The number of values stored
+    ///
+    cl_ulong GetCount() const {
+        return mCount;
+    }
+
+    ///
+    /// \fn      GetTotal
+    /// \return  The sum of all the values stored
+    ///
+    cl_ulong GetTotal() const {
+        return mTotal;
+    }
+
+    ///
+    /// \fn      GetMin
+    /// \return  The lowest value stored
+    ///
+    cl_ulong GetMin() const {
+        return mMin;
+    }
+
+    ///
+    /// \fn      GetMax
+    /// \return  The highest value stored
+    ///
+    cl_ulong GetMax() const {
+        return mMax;
+    }
+
+    ///
+    /// \fn      GetMean
+    /// \return  The mean of the stored values, 0 if empty
+    ///
+    double GetMean() const {
+        return (mCount == 0 ? 0.0 : static_cast<double>(mTotal) / mCount);
+    }
+};
+
+///
+/// \struct  LatencyBreakdown
+/// \brief   Decomposition of the latency of a command, in ns
+///
+struct LatencyBreakdown {
+    /// Time spent in the API call queuing the command
+    cl_ulong HostApi;
+    /// Time spent in the queue before submission (SUBMIT - QUEUED)
+    cl_ulong QueueWait;
+    /// Time between submission and execution start (START - SUBMIT)
+    cl_ulong LaunchLatency;
+    /// Time spent executing on the device (END - START)
+    cl_ulong Execution;
+};
+
+///
+/// \fn      GetElapsed
+/// \param   From The earliest timestamp
+/// \param   To   The latest timestamp
+/// \return  The elapsed time between both timestamps, 0 if they are reversed
+/// \brief   This function computes the elapsed time between two timestamps
+/// \details Some implementations report timestamps slightly out of order,
+///          this ensures unsigned differences don't wrap around.
+///
+inline cl_ulong GetElapsed(cl_ulong From, cl_ulong To) {
+    return (To > From ? To - From : 0);
+}
+
+///
+/// \fn      GetLatencyBreakdown
+/// \param   Record    A resolved command record
+/// \param   Breakdown Output decomposition of the command latency
+/// \return  CL_SUCCESS or the profiling status of the record
+/// \brief   This function decomposes the latency of a command
+///
+inline cl_int GetLatencyBreakdown(const CommandRecord & Record, LatencyBreakdown & Breakdown) {
+    Breakdown.HostApi = GetElapsed(Record.HostBegin, Record.HostEnd);
+    Breakdown.QueueWait = Breakdown.LaunchLatency = Breakdown.Execution = 0;
+
+    if (Record.Status != CL_SUCCESS) {
+        return Record.Status;
+    }
+
+    Breakdown.QueueWait = GetElapsed(Record.Queued, Record.Submit);
+    Breakdown.LaunchLatency = GetElapsed(Record.Submit, Record.Start);
+    Breakdown.Execution = GetElapsed(Record.Start, Record.End);
+
+    return CL_SUCCESS;
+}
+
+///
+/// \fn      GetThroughput
+/// \param   Record A resolved command record
+/// \param   Peaks  Peak figures of the device that executed the command
+/// \param   Report Output throughput of the command
+/// \return  CL_SUCCESS or the profiling status of the record
+/// \brief   This function computes the throughput achieved by a command
+/// \details Transfers are compared to the transfer bandwidth while kernels
+///          are compared to the global memory bandwidth.
+///
+inline cl_int GetThroughput(const CommandRecord & Record, const DevicePeaks & Peaks,
+                            ThroughputReport & Report) {
+    Report.Sequence = Record.Sequence;
+    Report.Type = Record.Type;
+    Report.Name = Record.Name;
+    Report.Duration = 0;
+    Report.Bandwidth = Report.Gflops = 0.0;
+    Report.BandwidthRatio = Report.GflopsRatio = 0.0;
+
+    if (Record.Status != CL_SUCCESS) {
+        return Record.Status;
+    }
+
+    //
+    // Bytes per ns are GB/s, operations per ns are GFLOP/s
+    //
+    Report.Duration = GetElapsed(Record.Start, Record.End);
+    if (Report.Duration != 0) {
+        Report.Bandwidth = static_cast<double>(Record.Bytes) / Report.Duration;
+        Report.Gflops = static_cast<double>(Record.Flops) / Report.Duration;
+    }
+
+    double PeakBandwidth = (Record.Type == KernelCommand ? Peaks.MemoryBandwidth :
+                                                           Peaks.TransferBandwidth);
+    if (PeakBandwidth > 0.0) {
+        Report.BandwidthRatio = Report.Bandwidth / PeakBandwidth;
+    }
+
+    if (Peaks.ComputeGflops > 0.0) {
+        Report.GflopsRatio = Report.Gflops / Peaks.ComputeGflops;
+    }
+
+    return CL_SUCCESS;
+}
+
+///
+/// \struct  OperationStatistics
+/// \brief   Aggregated statistics for a kernel or a transfer direction
+/// \details All the times are expressed in ns. Device times are taken between
+///          the start and the end of the command, host overhead is the time
+///          spent in the API call queuing the command.
+///
+struct OperationStatistics {
+    /// Type of the commands
+    CommandTypes     Type;
+    /// Name of the kernel for kernel commands, empty otherwise
+    std::string      Name;
+    /// Number of commands that completed
+    cl_ulong         Count;
+    /// Total device time
+    cl_ulong         DeviceTotal;
+    /// Mean device time
+    double           DeviceMean;
+    /// Median device time
+    cl_ulong         DeviceP50;
+    /// 95th percentile of the device time
+    cl_ulong         DeviceP95;
+    /// 99th percentile of the device time
+    cl_ulong         DeviceP99;
+    /// Highest device time
+    cl_ulong         DeviceMax;
+    /// Total host overhead
+    cl_ulong         HostTotal;
+    /// Mean host overhead
+    double           HostMean;
+    /// 99th percentile of the host overhead
+    cl_ulong         HostP99;
+    /// Total number of bytes transferred or declared
+    cl_ulong         Bytes;
+    /// Total number of floating point operations declared
+    cl_ulong         Flops;
+    /// Mean time spent in the queue before submission
+    double           QueueWaitMean;
+    /// Mean time between submission and execution start
+    double           LaunchLatencyMean;
+    /// Full histogram of the device times
+    LatencyHistogram DeviceHistogram;
+    /// Full histogram of the host overheads
+    LatencyHistogram HostHistogram;
+};
+
+///
+/// \class   StatisticsCollector
+/// \brief   Aggregates the profiled commands per kernel and transfer direction
+///
+class StatisticsCollector {
+private:
+    /// Key identifying an operation: its type and the kernel name
+    typedef std::pair<CommandTypes, std::string> OperationKey;
+
+    ///
+    /// \struct  OperationAccumulator
+    /// \brief   Everything accumulated for an operation
+    ///
+    struct OperationAccumulator {
+        /// Histogram of the device times
+        LatencyHistogram Device;
+        /// Histogram of the host overheads
+        LatencyHistogram Host;
+        /// Total number of bytes
+        cl_ulong         Bytes;
+        /// Total number of floating point operations
+        cl_ulong         Flops;
+        /// Total time spent in the queue before submission
+        cl_ulong         QueueWait;
+        /// Total time between submission and execution start
+        cl_ulong         LaunchLatency;
+
+        OperationAccumulator() : Bytes(0), Flops(0), QueueWait(0), LaunchLatency(0) {}
+    };
+
+    /// Accumulators of all the operations seen so far
+    std::map<OperationKey, OperationAccumulator> mOperations;
+
+public:
+    ///
+    /// \fn      Add
+    /// \param   Record A resolved command record
+    /// \brief   This function accounts a completed command
+    ///
+    void Add(const CommandRecord & Record) {
+        if (Record.Status != CL_SUCCESS) {
+            return;
+        }
+
+        LatencyBreakdown Breakdown;
+        GetLatencyBreakdown(Record, Breakdown);
+
+        OperationAccumulator & Operation = mOperations[OperationKey(Record.Type, Record.Name)];
+        Operation.Device.Add(Breakdown.Execution);
+        Operation.Host.Add(Breakdown.HostApi);
+        Operation.Bytes += Record.Bytes;
+        Operation.Flops += Record.Flops;
+        Operation.QueueWait += Breakdown.QueueWait;
+        Operation.LaunchLatency += Breakdown.LaunchLatency;
+    }
+
+    ///
+    /// \fn      GetSnapshot
+    /// \param   Statistics Output statistics for all the operations seen so far
+    /// \brief   This function computes the statistics of all the operations
+    ///
+    void GetSnapshot(std::vector<OperationStatistics> & Statistics) const {
+        Statistics.clear();
+
+        std::map<OperationKey, OperationAccumulator>::const_iterator it;
+        for (it = mOperations.begin(); it != mOperations.end(); ++it) {
+            const LatencyHistogram & Device = it->second.Device;
+            const LatencyHistogram & Host = it->second.Host;
+            OperationStatistics Operation;
+
+            Operation.Type = it->first.first;
+            Operation.Name = it->first.second;
+            Operation.Count = Device.GetCount();
+            Operation.DeviceTotal = Device.GetTotal();
+            Operation.DeviceMean = Device.GetMean();
+            Operation.DeviceP50 = Device.GetPercentile(50.0);
+            Operation.DeviceP95 = Device.GetPercentile(95.0);
+            Operation.DeviceP99 = Device.GetPercentile(99.0);
+            Operation.DeviceMax = Device.GetMax();
+            Operation.HostTotal = Host.GetTotal();
+            Operation.HostMean = Host.GetMean();
+            Operation.HostP99 = Host.GetPercentile(99.0);
+            Operation.Bytes = it->second.Bytes;
+            Operation.Flops = it->second.Flops;
+            Operation.QueueWaitMean = (Operation.Count == 0 ? 0.0 :
+                                       static_cast<double>(it->second.QueueWait) / Operation.Count);
+            Operation.LaunchLatencyMean = (Operation.Count == 0 ? 0.0 :
+                                           static_cast<double>(it->second.LaunchLatency) / Operation.Count);
+            Operation.DeviceHistogram = Device;
+            Operation.HostHistogram = Host;
+
+            Statistics.push_back(Operation);
+        }
+    }
+
+    ///
+    /// \fn    Reset
+    /// \brief This function drops all the statistics
+    ///
+    void Reset() {
+        mOperations.clear();
+    }
+};
+
+///
+/// \enum    RooflineBounds
+/// \brief   Enumeration for what limits a kernel on the roofline
+///
+enum RooflineBounds {
+    UnknownBound,     ///< Workload or device peaks are unknown
+    MemoryBound,      ///< The kernel sits left of the ridge point
+    ComputeBound,     ///< The kernel sits right of the ridge point
+    MaxRooflineBounds ///< Bound cannot be higher
+};
+
+///
+/// \enum    ReportFormats
+/// \brief   Enumeration for all the supported report formats
+///
+enum ReportFormats {
+    TextReport,      ///< Aligned table for humans
+    CsvReport,       ///< Comma separated values for tools
+    MaxReportFormats ///< Report format cannot be higher
+};
+
+///
+/// \struct  RooflinePoint
+/// \brief   Position of a kernel on the roofline of a device
+/// \details All the figures account for all the profiled launches of the kernel.
+///
+struct RooflinePoint {
+    /// Name of the kernel
+    std::string    Name;
+    /// Number of launches
+    cl_ulong       Count;
+    /// Total device time in ns
+    cl_ulong       DeviceTotal;
+    /// Total number of bytes declared or counted
+    cl_ulong       Bytes;
+    /// Total number of floating point operations declared
+    cl_ulong       Flops;
+    /// Arithmetic intensity in FLOP/byte, 0 if unknown
+    double         Intensity;
+    /// Achieved throughput in GFLOP/s
+    double         Gflops;
+    /// Achieved bandwidth in GB/s
+    double         Bandwidth;
+    /// Attainable throughput at this intensity in GFLOP/s, 0 if unknown
+    double         Roof;
+    /// Ratio of the achieved figure to the roof, 0 if unknown
+    double         Efficiency;
+    /// What limits the kernel
+    RooflineBounds Bound;
+};
+
+///
+/// \fn      GetRooflinePoint
+/// \param   Operation Aggregated statistics of a kernel
+/// \param   Peaks     Peak figures of the device that executed the kernel
+/// \param   Point     Position of the kernel on the roofline
+/// \brief   This function places a kernel on the roofline of a device
+/// \details The roof at intensity I is min(ComputeGflops, I * MemoryBandwidth)
+///          and the ridge point is ComputeGflops / MemoryBandwidth. A kernel
+///          with bytes but no operation is compared to the bandwidth only.
+///
+inline void GetRooflinePoint(const OperationStatistics & Operation, const DevicePeaks & Peaks,
+                             RooflinePoint & Point) {
+    Point.Name = Operation.Name;
+    Point.Count = Operation.Count;
+    Point.DeviceTotal = Operation.DeviceTotal;
+    Point.Bytes = Operation.Bytes;
+    Point.Flops = Operation.Flops;
+    Point.Intensity = Point.Gflops = Point.Bandwidth = 0.0;
+    Point.Roof = Point.Efficiency = 0.0;
+    Point.Bound = UnknownBound;
+
+    //
+    // Bytes per ns are GB/s, operations per ns are GFLOP/s
+    //
+    if (Operation.DeviceTotal != 0) {
+        Point.Gflops = static_cast<double>(Operation.Flops) / Operation.DeviceTotal;
+        Point.Bandwidth = static_cast<double>(Operation.Bytes) / Operation.DeviceTotal;
+    }
+
+    if (Operation.Bytes == 0 || Peaks.MemoryBandwidth <= 0.0) {
+        return;
+    }
+
+    if (Operation.Flops == 0) {
+        Point.Roof = 0.0;
+        Point.Efficiency = Point.Bandwidth / Peaks.MemoryBandwidth;
+        Point.Bound = MemoryBound;
+        return;
+    }
+
+    if (Peaks.ComputeGflops <= 0.0) {
+        return;
+    }
+
+    Point.Intensity = static_cast<double>(Operation.Flops) / Operation.Bytes;
+    Point.Roof = std::min(Peaks.ComputeGflops, Point.Intensity * Peaks.MemoryBandwidth);
+    Point.Efficiency = Point.Gflops / Point.Roof;
+    Point.Bound = (Point.Intensity * Peaks.MemoryBandwidth < Peaks.ComputeGflops ?
+                   MemoryBound : ComputeBound);
+}
+
+///
+/// \fn      WriteRooflineReport
+/// \param   Stream Stream in which the report is written
+/// \param   Points Positions of the kernels on the roofline
+/// \param   Peaks  Peak figures of the device
+/// \param   Format Format of the report, see ReportFormats
+/// \return  CL_SUCCESS, CL_INVALID_VALUE
+/// \brief   This function writes a roofline report
+///
+inline cl_int WriteRooflineReport(std::ostream & Stream, const std::vector<RooflinePoint> & Points,
+                                  const DevicePeaks & Peaks, unsigned int Format) {
+    static const char * Bounds[MaxRooflineBounds] = { "unknown", "memory", "compute" };
+
+    if (Format >= MaxReportFormats) {
+        return CL_INVALID_VALUE;
+    }
+
+    if (Format == CsvReport) {
+        Stream << "kernel,launches,device_ns,bytes,flops,intensity,gflops,bandwidth_gbs,"
+                  "roof_gflops,efficiency,bound\n";
+        for (size_t i = 0; i < Points.size(); i++) {
+            const RooflinePoint & Point = Points[i];
+            Stream << Point.Name << "," << Point.Count << "," << Point.DeviceTotal << ","
+                   << Point.Bytes << "," << Point.Flops << "," << Point.Intensity << ","
+                   << Point.Gflops << "," << Point.Bandwidth << "," << Point.Roof << ","
+                   << Point.Efficiency << "," << Bounds[Point.Bound] << "\n";
+        }
+
+        return (Stream.good() ? CL_SUCCESS : CL_INVALID_VALUE);
+    }
+
+    std::ostringstream Header;
+    Header << "Peak compute: " << Peaks.ComputeGflops << " GFLOP/s, peak bandwidth: "
+           << Peaks.MemoryBandwidth << " GB/s";
+    if (Peaks.MemoryBandwidth > 0.0) {
+        Header << ", ridge point: " << Peaks.ComputeGflops / Peaks.MemoryBandwidth << " FLOP/byte";
+    }
+    Stream << Header.str() << "\n\n";
+
+    size_t Width = 6;
+    for (size_t i = 0; i < Points.size(); i++) {
+        Width = std::max(Width, Points[i].Name.length());
+    }
+
+    Stream << std::string(Width, ' ').replace(0, 6, "Kernel")
+           << "  FLOP/byte     GFLOP/s        GB/s  Roof GFLOP/s  of roof  Bound\n";
+    for (size_t i = 0; i < Points.size(); i++) {
+        const RooflinePoint & Point = Points[i];
+        char Line[128];
+
+        snprintf(Line, sizeof(Line), "  %9.3f  %10.2f  %10.2f  %12.2f  %6.1f%%  ",
+                 Point.Intensity, Point.Gflops, Point.Bandwidth, Point.Roof,
+                 Point.Efficiency * 100.0);
+        Stream << Point.Name << std::string(Width - Point.Name.length(), ' ')
+               << Line << Bounds[Point.Bound] << "\n";
+    }
+
+    return (Stream.good() ? CL_SUCCESS : CL_INVALID_VALUE);
+}
+
+///
+/// \class   ProfilingRecorder
+/// \brief   Records all the commands queued by the wrapper
+/// \details Commands are kept in a ring buffer: once it is full, the oldest
+///          command is dropped for the newest. Timestamps are only queried
+///          when the records are requested or once the command is done, so
+///          that recording a command never requires waiting for it. Each
+///          command is accounted in the statistics once its timestamps are
+///          queried. A command still running when it is dropped from the
+///          ring buffer isn't accounted, but counted as dropped.
+///
+class ProfilingRecorder {
+private:
+    /// Ring buffer containing the records
+    std::vector<CommandRecord> mRecords;
+    /// Maximum number of records kept
+    size_t                     mCapacity;
+    /// Total number of commands recorded so far
+    unsigned long              mCount;
+    /// Name of the device behind each of the registered queues
+    std::vector<std::string>   mQueues;
+    /// Statistics of all the resolved commands
+    StatisticsCollector        mStatistics;
+    /// Sequence number of the first command accounted in the statistics
+    unsigned long              mStatisticsStart;
+    /// Telemetry of the last program builds
+    std::vector<BuildRecord>   mBuilds;
+    /// Number of commands dropped from the ring buffer before being accounted
+    cl_ulong                   mDropped;
+
+    ///
+    /// \fn      IsDone
+    /// \param   Record The record to check
+    /// \return  true if the command is done or failed, false if it is still running
+    ///
+    static bool IsDone(const CommandRecord & Record) {
+        cl_int Error;
+        cl_int Status = Record.Event.getInfo<CL_EVENT_COMMAND_EXECUTION_STATUS>(&Error);
+
+        return (Error != CL_SUCCESS || Status <= CL_COMPLETE);
+    }
+
+    ///
+    /// \fn      Resolve
+    /// \param   Record The record for which timestamps have to be queried
+    /// \brief   This function queries the timestamps of a command
+    /// \details It will block the caller until the command is done. The
+    ///          event is released once its timestamps are queried.
+    ///
+    void Resolve(CommandRecord & Record) {
+        if (Record.Resolved) {
+            return;
+        }
+
+        Record.Resolved = true;
+        Record.Status = Record.Event.wait();
+        if (Record.Status == CL_SUCCESS) {
+            QueryTimestamps(Record);
+        }
+        Record.Event = cl::Event();
+    }
+
+    ///
+    /// \fn      QueryTimestamps
+    /// \param   Record The record of a done command
+    /// \brief   This function queries the timestamps of a command and accounts it
+    ///
+    void QueryTimestamps(CommandRecord & Record) {
+        Record.Status = Record.Event.getProfilingInfo(CL_PROFILING_COMMAND_QUEUED, &Record.Queued);
+        if (Record.Status != CL_SUCCESS) {
+            return;
+        }
+
+        Record.Status = Record.Event.getProfilingInfo(CL_PROFILING_COMMAND_SUBMIT, &Record.Submit);
+        if (Record.Status != CL_SUCCESS) {
+            return;
+        }
+
+        Record.Status = Record.Event.getProfilingInfo(CL_PROFILING_COMMAND_START, &Record.Start);
+        if (Record.Status != CL_SUCCESS) {
+            return;
+        }
+
+        Record.Status = Record.Event.getProfilingInfo(CL_PROFILING_COMMAND_END, &Record.End);
+        if (Record.Sequence >= mStatisticsStart) {
+            mStatistics.Add(Record);
+        }
+    }
+
+    ///
+    /// \fn    ResolveAll
+    /// \brief This function queries the timestamps of all the kept commands
+    ///
+    void ResolveAll() {
+        for (size_t i = 0; i < mRecords.size(); i++) {
+            Resolve(mRecords[i]);
+        }
+    }
+
+    ///
+    /// \fn      Poll
+    /// \brief   This function queries the timestamps of the kept commands that are done
+    /// \details It never waits: commands still running are left unresolved.
+    ///
+    void Poll() {
+        for (size_t i = 0; i < mRecords.size(); i++) {
+            if (!mRecords[i].Resolved && IsDone(mRecords[i])) {
+                Resolve(mRecords[i]);
+            }
+        }
+    }
+
+public:
+    ///
+    /// \fn      ProfilingRecorder
+    /// \param   Capacity Maximum number of records to keep
+    /// \brief   Constructor that simply initializes an empty recorder
+    ///
+    ProfilingRecorder(size_t Capacity = 1024) {
+        mCapacity = (Capacity == 0 ? 1 : Capacity);
+        mCount = 0;
+        mStatisticsStart = 0;
+        mDropped = 0;
+    }
+
+    ///
+    /// \fn      SetCapacity
+    /// \param   Capacity Maximum number of records to keep
+    /// \return  CL_SUCCESS, CL_INVALID_VALUE
+    /// \brief   This function changes the size of the ring buffer
+    /// \details All the records previously kept are dropped.
+    ///
+    cl_int SetCapacity(size_t Capacity) {
+        if (Capacity == 0) {
+            return CL_INVALID_VALUE;
+        }
+
+        Clear();
+        mCapacity = Capacity;
+
+        return CL_SUCCESS;
+    }
+
+    ///
+    /// \fn      RegisterQueue
+    /// \param   Device Name of the device behind the queue
+    /// \return  The index of the queue to use when recording commands
+    /// \brief   This function registers a queue on which commands are queued
+    ///
+    unsigned int RegisterQueue(const std::string & Device) {
+        mQueues.push_back(Device);
+        return mQueues.size() - 1;
+    }
+
+    ///
+    /// \fn      Record
+    /// \param   Type       Type of the queued command
+    /// \param   Name       Name of the kernel, if any
+    /// \param   Bytes      Number of bytes transferred or declared, if any
+    /// \param   Flops      Number of floating point operations declared, if any
+    /// \param   GlobalSize Number of work-items, if any
+    /// \param   LocalSize  Number of work-items per work-group, if any
+    /// \param   Event      Event associated with the queued command
+    /// \param   Queue      Index of the queue, as returned by RegisterQueue()
+    /// \param   HostBegin  Host time before queuing the command
+    /// \param   HostEnd    Host time after queuing the command
+    /// \brief   This function records a newly queued command
+    /// \details If the ring buffer is full, the oldest command is accounted
+    ///          if it is done, and counted as dropped otherwise.
+    ///
+    void Record(CommandTypes Type, const std::string & Name, cl_ulong Bytes,
+                cl_ulong Flops, const cl::NDRange & GlobalSize, const cl::NDRange & LocalSize,
+                const cl::Event & Event, unsigned int Queue,
+                cl_ulong HostBegin, cl_ulong HostEnd) {
+        CommandRecord Record;
+
+        Record.Sequence = mCount;
+        Record.Type = Type;
+        Record.Name = Name;
+        Record.Bytes = Bytes;
+        Record.Flops = Flops;
+        Record.GlobalSize = GlobalSize;
+        Record.LocalSize = LocalSize;
+        Record.Queue = Queue;
+        Record.HostBegin = HostBegin;
+        Record.HostEnd = HostEnd;
+        Record.Queued = Record.Submit = Record.Start = Record.End = 0;
+        Record.Status = CL_PROFILING_INFO_NOT_AVAILABLE;
+        Record.Resolved = false;
+        Record.Event = Event;
+
+        if (mRecords.size() < mCapacity) {
+            mRecords.push_back(Record);
+        } else {
+            CommandRecord & Oldest = mRecords[mCount % mCapacity];
+            if (!Oldest.Resolved && IsDone(Oldest)) {
+                Resolve(Oldest);
+            }
+
+            if (!Oldest.Resolved && Oldest.Sequence >= mStatisticsStart) {
+                mDropped++;
+            }
+
+            mRecords[mCount % mCapacity] = Record;
+        }
+
+        mCount++;
+    }
+
+    ///
+    /// \fn      RecordBuild
+    /// \param   Build Telemetry of a program build
+    /// \brief   This function records the telemetry of a program build
+    /// \details As many builds as commands are kept, the oldest are dropped.
+    ///
+    void RecordBuild(const BuildRecord & Build) {
+        if (mBuilds.size() >= mCapacity) {
+            mBuilds.erase(mBuilds.begin());
+        }
+
+        mBuilds.push_back(Build);
+    }
+
+    ///
+    /// \fn      GetBuildRecords
+    /// \param   Builds Output telemetry of the last program builds, oldest first
+    /// \brief   This function returns the telemetry of the last program builds
+    ///
+    void GetBuildRecords(std::vector<BuildRecord> & Builds) const {
+        Builds = mBuilds;
+    }
+
+    ///
+    /// \fn      GetPendingCommands
+    /// \return  The number of recorded commands that are not done yet
+    /// \brief   This function computes the depth of the queues
+    ///
+    cl_ulong GetPendingCommands() const {
+        cl_ulong Pending = 0;
+
+        for (size_t i = 0; i < mRecords.size(); i++) {
+            if (!mRecords[i].Resolved &&
+                mRecords[i].Event.getInfo<CL_EVENT_COMMAND_EXECUTION_STATUS>() > CL_COMPLETE) {
+                Pending++;
+            }
+        }
+
+        return Pending;
+    }
+
+    ///
+    /// \fn      GetDroppedCommands
+    /// \return  The number of commands dropped before being accounted in the statistics
+    /// \details This number never decreases, not even when the records are
+    ///          cleared or the statistics reset.
+    ///
+    cl_ulong GetDroppedCommands() const {
+        return mDropped;
+    }
+
+    ///
+    /// \fn      GetLastRecord
+    /// \param   Record Output record of the last queued command
+    /// \return  CL_SUCCESS, CL_INVALID_OPERATION
+    /// \brief   This function returns the last recorded command
+    /// \details It will wait for the command to be done so that its timestamps
+    ///          are available.
+    ///
+    cl_int GetLastRecord(CommandRecord & Record) {
+        if (mRecords.empty()) {
+            return CL_INVALID_OPERATION;
+        }
+
+        CommandRecord & Last = mRecords[(mCount - 1) % mCapacity];
+        Resolve(Last);
+        Record = Last;
+
+        return CL_SUCCESS;
+    }
+
+    ///
+    /// \fn      GetRecords
+    /// \param   Records Output list of the kept records, oldest first
+    /// \return  CL_SUCCESS
+    /// \brief   This function returns all the kept records
+    /// \details It will wait for all the recorded commands to be done so that
+    ///          their timestamps are available. Each record has its own
+    ///          status in case its timestamps couldn't be queried.
+    ///
+    cl_int GetRecords(std::vector<CommandRecord> & Records) {
+        Records.clear();
+        Records.reserve(mRecords.size());
+
+        size_t First = (mRecords.size() < mCapacity ? 0 : mCount % mCapacity);
+        for (size_t i = 0; i < mRecords.size(); i++) {
+            CommandRecord & Record = mRecords[(First + i) % mRecords.size()];
+            Resolve(Record);
+            Records.push_back(Record);
+        }
+
+        return CL_SUCCESS;
+    }
+
+    ///
+    /// \fn      ExportChromeTrace
+    /// \param   Stream The stream in which the trace is written
+    /// \return  CL_SUCCESS, CL_INVALID_VALUE
+    /// \brief   This function writes the kept records as a Chrome trace
+    /// \details The trace uses the Chrome trace event JSON format, that can be
+    ///          opened with Perfetto or chrome://tracing. Host API calls are on
+    ///          their own track, while device executions are on one track per
+    ///          queue, grouped by device. Device timestamps are aligned on the
+    ///          host clock using the first command of each queue, considering
+    ///          that it was queued in the middle of its API call.
+    ///
+    cl_int ExportChromeTrace(std::ostream & Stream) {
+        std::vector<CommandRecord> Records;
+        GetRecords(Records);
+
+        //
+        // Compute the offset between host and device clocks for each queue
+        // and the origin of the whole trace
+        //
+        std::vector<double> Offsets(mQueues.size(), 0.0);
+        std::vector<bool> Aligned(mQueues.size(), false);
+        cl_ulong Origin = (Records.empty() ? 0 : Records[0].HostBegin);
+        for (size_t i = 0; i < Records.size(); i++) {
+            const CommandRecord & Record = Records[i];
+            if (Record.Status == CL_SUCCESS && Record.Queue < mQueues.size() &&
+                !Aligned[Record.Queue]) {
+                Offsets[Record.Queue] = (Record.HostBegin / 2.0 + Record.HostEnd / 2.0) -
+                                        static_cast<double>(Record.Queued);
+                Aligned[Record.Queue] = true;
+            }
+
+            Origin = std::min(Origin, Record.HostBegin);
+        }
+
+        //
+        // Devices are processes in the trace, queues are threads
+        //
+        std::map<std::string, unsigned int> Devices;
+        std::ostringstream Trace;
+        Trace.precision(3);
+        Trace << std::fixed;
+        Trace << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+        Trace << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,"
+                 "\"args\":{\"name\":\"Host\"}},\n";
+        Trace << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,"
+                 "\"args\":{\"name\":\"API calls\"}}";
+        for (unsigned int i = 0; i < mQueues.size(); i++) {
+            if (Devices.find(mQueues[i]) == Devices.end()) {
+                unsigned int Pid = Devices.size() + 1;
+                Devices[mQueues[i]] = Pid;
+                Trace << ",\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << Pid
+                      << ",\"args\":{\"name\":\"" << EscapeJson(mQueues[i]) << "\"}}";
+            }
+
+            Trace << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":"
+                  << Devices[mQueues[i]] << ",\"tid\":" << i
+                  << ",\"args\":{\"name\":\"Queue " << i << "\"}}";
+        }
+
+        for (size_t i = 0; i < Records.size(); i++) {
+            static const char * Names[MaxCommands] = { "enqueueNDRangeKernel",
+                                                       "enqueueReadBuffer",
+                                                       "enqueueWriteBuffer" };
+            const CommandRecord & Record = Records[i];
+            std::string Name = (Record.Type == KernelCommand ? Record.Name : Names[Record.Type]);
+
+            Trace << ",\n{\"name\":\"" << Names[Record.Type]
+                  << "\",\"cat\":\"api\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":"
+                  << (Record.HostBegin - Origin) / 1000.0 << ",\"dur\":"
+                  << GetElapsed(Record.HostBegin, Record.HostEnd) / 1000.0
+                  << ",\"args\":{\"sequence\":" << Record.Sequence
+                  << ",\"command\":\"" << EscapeJson(Name) << "\"}}";
+
+            if (Record.Status != CL_SUCCESS || Record.Queue >= mQueues.size()) {
+                continue;
+            }
+
+            double Start = Record.Start + Offsets[Record.Queue] - Origin;
+            Trace << ",\n{\"name\":\"" << EscapeJson(Name) << "\",\"cat\":\""
+                  << (Record.Type == KernelCommand ? "kernel" : "transfer")
+                  << "\",\"ph\":\"X\",\"pid\":" << Devices[mQueues[Record.Queue]]
+                  << ",\"tid\":" << Record.Queue << ",\"ts\":" << Start / 1000.0
+                  << ",\"dur\":" << GetElapsed(Record.Start, Record.End) / 1000.0
+                  << ",\"args\":{\"sequence\":" << Record.Sequence
+                  << ",\"bytes\":" << Record.Bytes
+                  << ",\"flops\":" << Record.Flops
+                  << ",\"queued_ns\":" << Record.Queued
+                  << ",\"submit_ns\":" << Record.Submit
+                  << ",\"start_ns\":" << Record.Start
+                  << ",\"end_ns\":" << Record.End << "}}";
+        }
+
+        Trace << "\n]}\n";
+        Stream << Trace.str();
+
+        return (Stream.good() ? CL_SUCCESS : CL_INVALID_VALUE);
+    }
+
+    ///
+    /// \fn      GetStatistics
+    /// \param   Statistics Output statistics per kernel and transfer direction
+    /// \brief   This function returns the statistics of all the commands
+    /// \details It will wait for all the recorded commands to be done so that
+    ///          they are accounted.
+    ///
+    void GetStatistics(std::vector<OperationStatistics> & Statistics) {
+        ResolveAll();
+        mStatistics.GetSnapshot(Statistics);
+    }
+
+    ///
+    /// \fn      GetCompletedStatistics
+    /// \param   Statistics Output statistics per kernel and transfer direction
+    /// \brief   This function returns the statistics of the commands done so far
+    /// \details Contrary to GetStatistics(), it never waits: commands still
+    ///          running are accounted by a later call.
+    ///
+    void GetCompletedStatistics(std::vector<OperationStatistics> & Statistics) {
+        Poll();
+        mStatistics.GetSnapshot(Statistics);
+    }
+
+    ///
+    /// \fn      ResetStatistics
+    /// \brief   This function drops all the statistics
+    /// \details Commands recorded before the reset won't be accounted anymore,
+    ///          even if they are not done yet. The number of dropped commands
+    ///          is kept, as it is exported as a counter.
+    ///
+    void ResetStatistics() {
+        mStatistics.Reset();
+        mStatisticsStart = mCount;
+    }
+
+    ///
+    /// \fn      Clear
+    /// \brief   This function drops all the kept records
+    /// \details It never waits: the commands already done are accounted in
+    ///          the statistics, the other ones are counted as dropped.
+    ///
+    void Clear() {
+        Poll();
+        for (size_t i = 0; i < mRecords.size(); i++) {
+            if (!mRecords[i].Resolved && mRecords[i].Sequence >= mStatisticsStart) {
+                mDropped++;
+            }
+        }
+
+        mRecords.clear();
+        mCount = 0;
+        mStatisticsStart = 0;
+    }
+};
+
+///
+/// \struct  WrapperCounters
+/// \brief   Counters of everything done through the wrapper
+/// \details Contrary to the recorder, they account for all the commands,
+///          whether they were profiled or not.
+///
+struct WrapperCounters {
+    /// Number of kernels launched
+    cl_ulong KernelLaunches;
+    /// Number of bytes read from device buffers
+    cl_ulong BytesRead;
+    /// Number of bytes written into device buffers
+    cl_ulong BytesWritten;
+    /// Number of bytes allocated for device buffers
+    cl_ulong BytesAllocated;
+};
+
+///
+/// \fn      EscapeLabel
+/// \param   Value The label value to escape
+/// \return  The escaped label value
+/// \brief   This function escapes a label value for the Prometheus text format
+///
+inline std::string EscapeLabel(const std::string & Value) {
+    std::string Escaped;
+
+    for (size_t i = 0; i < Value.length(); i++) {
+        if (Value[i] == '\\' || Value[i] == '"') {
+            Escaped += '\\';
+            Escaped += Value[i];
+        } else if (Value[i] == '\n') {
+            Escaped += "\\n";
+        } else {
+            Escaped += Value[i];
+        }
+    }
+
+    return Escaped;
+}
+
+///
+/// \fn      WritePrometheusHistogram
+/// \param   Stream    The stream in which the histogram is written
+/// \param   Name      Name of the metric
+/// \param   Labels    Labels of the histogram, already escaped, without braces
+/// \param   Histogram The histogram to write, in ns
+/// \brief   This function writes a histogram in the Prometheus text format
+/// \details Values are exposed in seconds, with fixed bucket bounds going
+///          from 1 us to 10 s. Each bound accounts for the HDR buckets whose
+///          upper limit is below it.
+///
+inline void WritePrometheusHistogram(std::ostream & Stream, const std::string & Name,
+                                     const std::string & Labels,
+                                     const LatencyHistogram & Histogram) {
+    static const double Bounds[] = { 1e-6, 2.5e-6, 5e-6, 1e-5, 2.5e-5, 5e-5,
+                                     1e-4, 2.5e-4, 5e-4, 1e-3, 2.5e-3, 5e-3,
+                                     1e-2, 2.5e-2, 5e-2, 1e-1, 2.5e-1, 5e-1,
+                                     1.0, 2.5, 5.0, 10.0 };
+
+    cl_ulong Seen = 0;
+    unsigned int Bucket = 0;
+    for (size_t i = 0; i < sizeof(Bounds) / sizeof(Bounds[0]); i++) {
+        while (Bucket < LatencyHistogram::Buckets &&
+               LatencyHistogram::GetBucketLimit(Bucket) <= Bounds[i] * 1e9) {
+            Seen += Histogram.GetBucketCount(Bucket);
+            Bucket++;
+        }
+
+        Stream << Name << "_bucket{" << Labels << ",le=\"" << Bounds[i] << "\"} "
+               << Seen << "\n";
+    }
+
+    Stream << Name << "_bucket{" << Labels << ",le=\"+Inf\"} " << Histogram.GetCount() << "\n";
+    Stream << Name << "_sum{" << Labels << "} " << Histogram.GetTotal() / 1e9 << "\n";
+    Stream << Name << "_count{" << Labels << "} " << Histogram.GetCount() << "\n";
+}
+
+///
+/// \class   NullRecorder
+/// \brief   Recorder that doesn't record anything
+/// \details It provides the same interface as ProfilingRecorder with empty
+///          inline functions, so that the compiler can drop all of them.
+///
+class NullRecorder {
+public:
+    ///
+    /// \fn      SetCapacity
+    /// \brief   Does nothing
+    /// \see     ProfilingRecorder::SetCapacity()
+    ///
+    cl_int SetCapacity(size_t Capacity) {
+        (void)Capacity;
+        return CL_INVALID_OPERATION;
+    }
+
+    ///
+    /// \fn      RegisterQueue
+    /// \brief   Does nothing
+    /// \see     ProfilingRecorder::RegisterQueue()
+    ///
+    unsigned int RegisterQueue(const std::string & Device) {
+        (void)Device;
+        return 0;
+    }
+
+    ///
+    /// \fn      Record
+    /// \brief   Does nothing
+    /// \see     ProfilingRecorder::Record()
+    ///
+    void Record(CommandTypes Type, const std::string & Name, cl_ulong Bytes,
+                cl_ulong Flops, const cl::NDRange & GlobalSize,
+                const cl::NDRange & LocalSize, const cl::Event & Event,
+                unsigned int Queue, cl_ulong HostBegin, cl_ulong HostEnd) {
+        (void)Type; (void)Name; (void)Bytes; (void)Flops; (void)GlobalSize;
+        (void)LocalSize; (void)Event; (void)Queue; (void)HostBegin; (void)HostEnd;
+    }
+
+    ///
+    /// \fn      RecordBuild
+    /// \brief   Does nothing
+    /// \see     ProfilingRecorder::RecordBuild()
+    ///
+    void RecordBuild(const BuildRecord & Build) {
+        (void)Build;
+    }
+
+    ///
+    /// \fn      GetBuildRecords
+    /// \brief   Does nothing
+    /// \see     ProfilingRecorder::GetBuildRecords()
+    ///
+    void GetBuildRecords(std::vector<BuildRecord> & Builds) const {
+        Builds.clear();
+    }
+
+    ///
+    /// \fn      GetPendingCommands
+    /// \brief   Does nothing
+    /// \see     ProfilingRecorder::GetPendingCommands()
+    ///
+    cl_ulong GetPendingCommands() const {
+        return 0;
+    }
+
+    ///
+    /// \fn      GetDroppedCommands
+    /// \brief   Does nothing
+    /// \see     ProfilingRecorder::GetDroppedCommands()
+    ///
+    cl_ulong GetDroppedCommands() const {
+        return 0;
+    }
+
+    ///
+    /// \fn      GetLastRecord
+    /// \brief   Does nothing
+    /// \see     ProfilingRecorder::GetLastRecord()
+    ///
+    cl_int GetLastRecord(CommandRecord & Record) {
+        (void)Record;
+        return CL_PROFILING_INFO_NOT_AVAILABLE;
+    }
+
+    ///
+    /// \fn      GetRecords
+    /// \brief   Does nothing
+    /// \see     ProfilingRecorder::GetRecords()
+    ///
+    cl_int GetRecords(std::vector<CommandRecord> & Records) {
+        Records.clear();
+        return CL_SUCCESS;
+    }
+
+    ///
+    /// \fn      ExportChromeTrace
+    /// \brief   Does nothing
+    /// \see     ProfilingRecorder::ExportChromeTrace()
+    ///
+    cl_int ExportChromeTrace(std::ostream & Stream) {
+        (void)Stream;
+        return CL_INVALID_OPERATION;
+    }
+
+    ///
+    /// \fn      GetStatistics
+    /// \brief   Does nothing
+    /// \see     ProfilingRecorder::GetStatistics()
+    ///
+    void GetStatistics(std::vector<OperationStatistics> & Statistics) {
+        Statistics.clear();
+    }
+
+    ///
+    /// \fn      GetCompletedStatistics
+    /// \brief   Does nothing
+    /// \see     ProfilingRecorder::GetCompletedStatistics()
+    ///
+    void GetCompletedStatistics(std::vector<OperationStatistics> & Statistics) {
+        Statistics.clear();
+    }
+
+    ///
+    /// \fn      ResetStatistics
+    /// \brief   Does nothing
+    /// \see     ProfilingRecorder::ResetStatistics()
+    ///
+    void ResetStatistics() {
+    }
+
+    ///
+    /// \fn      Clear
+    /// \brief   Does nothing
+    /// \see     ProfilingRecorder::Clear()
+    ///
+    void Clear() {
+    }
+};
+
+///
+/// \struct  NoInstrumentation
+/// \brief   Instrumentation policy compiling out all the instrumentation
+/// \details No command is timed, recorded or accounted. By default, queues
+///          are created without profiling.
+///
+struct NoInstrumentation {
+    /// Whether commands are timed and recorded
+    static const bool Enabled = false;
+    /// Recorder used by the wrapper
+    typedef NullRecorder Recorder;
+};
+
+///
+/// \struct  FullTracing
+/// \brief   Instrumentation policy recording everything
+/// \details All the profiled commands are timed, recorded and accounted.
+///
+struct FullTracing {
+    /// Whether commands are timed and recorded
+    static const bool Enabled = true;
+    /// Recorder used by the wrapper
+    typedef ProfilingRecorder Recorder;
+};
+}
+
+#endif
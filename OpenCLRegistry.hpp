@@ -0,0 +1,334 @@
+///
+/// \file    OpenCLRegistry.hpp
+/// \brief   Process-wide registry of the OpenCL devices
+/// \details This file provides the registry that enumerates the platforms
+///          and their devices once per process and keeps the properties the
+///          wrapper queries, so that creating wrapper instances is cheap. It
+///          also provides the scores used to select the fastest device.
+/// \date    17-10-2026
+///
+
+#ifndef OPENCLWRAPPER_REGISTRY_HPP
+#define OPENCLWRAPPER_REGISTRY_HPP
+
+#include <CL/cl.hpp>
+#include "OpenCLDeviceProfile.hpp"
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace OpenCLWrapper {
+
+///
+/// \struct  DeviceInfo
+/// \brief   Properties of a device, as queried once by the registry
+///
+struct DeviceInfo {
+    /// The device
+    cl::Device     Device;
+    /// Index of the platform of the device in the registry
+    unsigned int   Platform;
+    /// Type of the device
+    cl_device_type Type;
+    /// Whether the device is available
+    bool           Available;
+    /// Whether a compiler is available for the device
+    bool           CompilerAvailable;
+    /// Name of the device
+    std::string    Name;
+    /// Vendor of the device
+    std::string    Vendor;
+    /// Version of the driver
+    std::string    Driver;
+    /// Number of compute units
+    cl_uint        ComputeUnits;
+    /// Maximum clock frequency in MHz
+    cl_uint        ClockFrequency;
+    /// Native float vector width
+    cl_uint        NativeVectorWidthFloat;
+    /// Maximum number of work-items per work-group
+    size_t         MaxWorkGroupSize;
+    /// Local memory available per compute unit, in bytes
+    cl_ulong       LocalMemSize;
+    /// Global memory size, in bytes
+    cl_ulong       GlobalMemSize;
+    /// Maximum size of a single allocation, in bytes
+    cl_ulong       MaxMemAllocSize;
+    /// Supported extensions, separated by spaces
+    std::string    Extensions;
+};
+
+///
+/// \typedef DeviceScorer
+/// \brief   Function scoring a device, the highest score is selected
+/// \details The profile is 0 if the device wasn't characterized. A negative
+///          score excludes the device.
+///
+typedef std::function<double(const DeviceInfo &, const DeviceProfile *)> DeviceScorer;
+
+///
+/// \fn      GetEstimatedGflops
+/// \param   Info Properties of the device
+/// \return  The estimated peak floating point throughput in GFLOP/s
+/// \brief   This function estimates the compute peak of a device
+/// \details The compute peak is derived from the number of compute units,
+///          their clock and the number of lanes they run, counting a mad
+///          as two operations. A CPU compute unit is a core running as many
+///          lanes as its native float vector width while other compute
+///          units are assumed to run 64 lanes.
+///
+inline double GetEstimatedGflops(const DeviceInfo & Info) {
+    double Lanes = ((Info.Type & CL_DEVICE_TYPE_CPU) ? std::max(Info.NativeVectorWidthFloat, 1U) : 64.0);
+    return Info.ComputeUnits * (Info.ClockFrequency / 1000.0) * Lanes * 2.0;
+}
+
+///
+/// \fn      GetDefaultDeviceScore
+/// \param   Info    Properties of the device
+/// \param   Profile Measured profile of the device, 0 if none
+/// \return  The score of the device
+/// \brief   This function is the default device scorer
+/// \details The score is the peak GFLOP/s, measured if the device was
+///          characterized and estimated otherwise. The measured memory
+///          bandwidth, counted as one operation per byte, is added so that
+///          bandwidth bound workloads aren't ignored.
+///
+inline double GetDefaultDeviceScore(const DeviceInfo & Info, const DeviceProfile * Profile) {
+    if (Profile != 0) {
+        DevicePeaks Peaks = GetProfilePeaks(*Profile);
+        if (Peaks.ComputeGflops > 0.0) {
+            return Peaks.ComputeGflops + Peaks.MemoryBandwidth;
+        }
+    }
+
+    return GetEstimatedGflops(Info);
+}
+
+///
+/// \fn      HasExtensions
+/// \param   Info       Properties of the device
+/// \param   Extensions Required extensions, separated by spaces
+/// \return  true if the device supports all the extensions, false otherwise
+///
+inline bool HasExtensions(const DeviceInfo & Info, const std::string & Extensions) {
+    std::string Supported = " " + Info.Extensions + " ";
+    size_t Begin = 0;
+
+    while ((Begin = Extensions.find_first_not_of(' ', Begin)) != std::string::npos) {
+        size_t End = Extensions.find(' ', Begin);
+        std::string Extension = Extensions.substr(Begin, End - Begin);
+        if (Supported.find(" " + Extension + " ") == std::string::npos) {
+            return false;
+        }
+
+        Begin = End;
+    }
+
+    return true;
+}
+
+///
+/// \class   DeviceRegistry
+/// \brief   Enumerates the platforms and their devices once per process
+/// \details The registry is built on first use, in a thread-safe way.
+///          Platforms are enumerated in parallel, as some drivers are slow
+///          to answer. Devices are kept in platform order, then in the
+///          order their platform reports them.
+///
+class DeviceRegistry {
+private:
+    /// Platforms found on the system
+    std::vector<cl::Platform> mPlatforms;
+    /// Devices of all the platforms
+    std::vector<DeviceInfo>   mDevices;
+    /// Error of the platform enumeration
+    cl_int                    mError;
+
+    ///
+    /// \fn      EnumeratePlatform
+    /// \param   Platform The platform to enumerate
+    /// \param   Index    Index of the platform in the registry
+    /// \return  The properties of all the devices of the platform
+    /// \brief   This function queries all the devices of a platform
+    /// \details A platform without device, or failing to report them, has
+    ///          no device. Devices whose properties can't be queried are
+    ///          skipped.
+    ///
+    static std::vector<DeviceInfo> EnumeratePlatform(cl::Platform Platform, unsigned int Index) {
+        std::vector<cl::Device> Devices;
+        std::vector<DeviceInfo> Infos;
+
+        if (Platform.getDevices(CL_DEVICE_TYPE_ALL, &Devices) != CL_SUCCESS) {
+            return Infos;
+        }
+
+        for (unsigned int i = 0; i < Devices.size(); i++) {
+            DeviceInfo Info;
+            if (QueryDeviceInfo(Devices[i], Info) == CL_SUCCESS) {
+                Info.Platform = Index;
+                Infos.push_back(Info);
+            }
+        }
+
+        return Infos;
+    }
+
+    ///
+    /// \fn      DeviceRegistry
+    /// \brief   Constructor that enumerates all the platforms
+    /// \details One task is started per platform. If a task can't be
+    ///          started, the platform is enumerated on the caller thread.
+    ///
+    DeviceRegistry() {
+        std::vector<std::future<std::vector<DeviceInfo> > > Tasks;
+
+        mError = cl::Platform::get(&mPlatforms);
+        if (mError != CL_SUCCESS) {
+            mPlatforms.clear();
+            return;
+        }
+
+        for (unsigned int i = 0; i < mPlatforms.size(); i++) {
+            try {
+                Tasks.push_back(std::async(std::launch::async, EnumeratePlatform,
+                                           mPlatforms[i], i));
+            } catch (const std::system_error &) {
+                Tasks.push_back(std::async(std::launch::deferred, EnumeratePlatform,
+                                           mPlatforms[i], i));
+            }
+        }
+
+        for (unsigned int i = 0; i < Tasks.size(); i++) {
+            std::vector<DeviceInfo> Infos = Tasks[i].get();
+            mDevices.insert(mDevices.end(), Infos.begin(), Infos.end());
+        }
+    }
+
+    ///
+    /// \fn      DeviceRegistry
+    /// \param   Registry The registry to copy
+    /// \brief   Copy constructor
+    /// \details Disallow the copy constructor
+    ///
+    DeviceRegistry(const DeviceRegistry & Registry);
+
+    ///
+    /// \fn      operator=
+    /// \param   Registry The registry to affect to the other
+    /// \return  The affected registry
+    /// \brief   Affectation operator
+    /// \details Disallow the affectation operator
+    ///
+    DeviceRegistry & operator=(const DeviceRegistry & Registry);
+
+public:
+    ///
+    /// \fn      QueryDeviceInfo
+    /// \param   Device The device to query
+    /// \param   Info   Properties of the device
+    /// \return  Any of the OpenCL cl::Device::getInfo error code
+    /// \brief   This function queries the properties of a device
+    /// \details The platform index is left to 0.
+    ///
+    static cl_int QueryDeviceInfo(const cl::Device & Device, DeviceInfo & Info) {
+        cl_int Error;
+
+        Info.Device = Device;
+        Info.Platform = 0;
+        Info.Type = Device.getInfo<CL_DEVICE_TYPE>(&Error);
+        if (Error != CL_SUCCESS) {
+            return Error;
+        }
+
+        Info.Available = (Device.getInfo<CL_DEVICE_AVAILABLE>() != CL_FALSE);
+        Info.CompilerAvailable = (Device.getInfo<CL_DEVICE_COMPILER_AVAILABLE>() != CL_FALSE);
+        Info.Name = Device.getInfo<CL_DEVICE_NAME>();
+        Info.Vendor = Device.getInfo<CL_DEVICE_VENDOR>();
+        Info.Driver = Device.getInfo<CL_DRIVER_VERSION>();
+        Info.ComputeUnits = Device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>();
+        Info.ClockFrequency = Device.getInfo<CL_DEVICE_MAX_CLOCK_FREQUENCY>();
+        Info.NativeVectorWidthFloat = Device.getInfo<CL_DEVICE_NATIVE_VECTOR_WIDTH_FLOAT>();
+        Info.MaxWorkGroupSize = Device.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>();
+        Info.LocalMemSize = Device.getInfo<CL_DEVICE_LOCAL_MEM_SIZE>();
+        Info.GlobalMemSize = Device.getInfo<CL_DEVICE_GLOBAL_MEM_SIZE>();
+        Info.MaxMemAllocSize = Device.getInfo<CL_DEVICE_MAX_MEM_ALLOC_SIZE>();
+        Info.Extensions = Device.getInfo<CL_DEVICE_EXTENSIONS>(&Error);
+
+        return Error;
+    }
+
+    ///
+    /// \fn      Get
+    /// \return  The registry of the process
+    /// \brief   This function returns the registry, building it on first use
+    ///
+    static const DeviceRegistry & Get() {
+        static const DeviceRegistry Registry;
+        return Registry;
+    }
+
+    ///
+    /// \fn      GetPlatforms
+    /// \return  The platforms found on the system
+    ///
+    const std::vector<cl::Platform> & GetPlatforms() const {
+        return mPlatforms;
+    }
+
+    ///
+    /// \fn      GetDevices
+    /// \return  The devices of all the platforms
+    ///
+    const std::vector<DeviceInfo> & GetDevices() const {
+        return mDevices;
+    }
+
+    ///
+    /// \fn      GetError
+    /// \return  The error of the platform enumeration, CL_SUCCESS if none
+    ///
+    cl_int GetError() const {
+        return mError;
+    }
+
+    ///
+    /// \fn      Find
+    /// \param   Device The device to look for
+    /// \return  The properties of the device, 0 if it isn't known
+    ///
+    const DeviceInfo * Find(const cl::Device & Device) const {
+        for (size_t i = 0; i < mDevices.size(); i++) {
+            if (mDevices[i].Device() == Device()) {
+                return &mDevices[i];
+            }
+        }
+
+        return 0;
+    }
+
+    ///
+    /// \fn      GetDeviceInfo
+    /// \param   Device The device to look for
+    /// \param   Info   Properties of the device
+    /// \return  Any of the OpenCL cl::Device::getInfo error code
+    /// \brief   This function returns the properties of any device
+    /// \details Devices unknown to the registry, such as sub-devices, are
+    ///          queried.
+    ///
+    cl_int GetDeviceInfo(const cl::Device & Device, DeviceInfo & Info) const {
+        const DeviceInfo * Found = Find(Device);
+        if (Found == 0) {
+            return QueryDeviceInfo(Device, Info);
+        }
+
+        Info = *Found;
+
+        return CL_SUCCESS;
+    }
+};
+}
+
+#endif
@@ -0,0 +1,162 @@
+///
+/// \file    OpenCLRuntime.hpp
+/// \brief   Runtime shared between OpenCL wrapper instances
+/// \details This file provides the runtime several wrapper instances can
+///          attach to, so that they use the same context, queues, programs
+///          and buffers instead of creating their own.
+/// \date    17-10-2026
+///
+
+#ifndef OPENCLWRAPPER_RUNTIME_HPP
+#define OPENCLWRAPPER_RUNTIME_HPP
+
+#include <CL/cl.hpp>
+#include "OpenCLCache.hpp"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace OpenCLWrapper {
+
+///
+/// \class   SharedRuntime
+/// \brief   Context, queues, program cache and buffer pool shared by instances
+/// \details The runtime is reference-counted through std::shared_ptr: it
+///          lives as long as an instance is attached to it. One queue is
+///          created per set of queue properties and shared by all the
+///          instances asking for them. All the methods are thread-safe.
+///
+class SharedRuntime {
+private:
+    /// Lock protecting the queues
+    std::mutex                                             mMutex;
+    /// List of devices that are in the context
+    std::vector<cl::Device>                                mDevices;
+    /// Device index in mDevices that points to the used device
+    unsigned int                                           mDevice;
+    /// Context of the OpenCL execution
+    cl::Context                                            mContext;
+    /// Queues on the used device, indexed by their properties
+    std::map<cl_command_queue_properties, cl::CommandQueue> mQueues;
+    /// Programs already built in mContext
+    ProgramCache                                           mPrograms;
+    /// Buffers released in mContext
+    BufferPool                                             mBuffers;
+
+    ///
+    /// \fn      SharedRuntime
+    /// \param   Runtime The runtime to copy
+    /// \brief   Copy constructor
+    /// \details Disallow the copy constructor
+    ///
+    SharedRuntime(const SharedRuntime & Runtime);
+
+    ///
+    /// \fn      operator=
+    /// \param   Runtime The runtime to affect to the other
+    /// \return  The affected runtime
+    /// \brief   Affectation operator
+    /// \details Disallow the affectation operator
+    ///
+    SharedRuntime & operator=(const SharedRuntime & Runtime);
+
+public:
+    ///
+    /// \fn      SharedRuntime
+    /// \param   Devices List of devices that are in the context
+    /// \param   Device  Device index in Devices that points to the used device
+    /// \param   Context Context of the OpenCL execution
+    /// \brief   Constructor that takes over an initialized context
+    ///
+    SharedRuntime(const std::vector<cl::Device> & Devices, unsigned int Device,
+                  const cl::Context & Context)
+        : mDevices(Devices), mDevice(Device), mContext(Context) {
+    }
+
+    ///
+    /// \fn      GetDevices
+    /// \return  The list of devices that are in the context
+    ///
+    std::vector<cl::Device> & GetDevices() {
+        return mDevices;
+    }
+
+    ///
+    /// \fn      GetDevice
+    /// \return  The device index in GetDevices() that points to the used device
+    ///
+    unsigned int GetDevice() const {
+        return mDevice;
+    }
+
+    ///
+    /// \fn      GetContext
+    /// \return  The context of the OpenCL execution
+    ///
+    cl::Context & GetContext() {
+        return mContext;
+    }
+
+    ///
+    /// \fn      GetQueue
+    /// \param   Properties Properties of the queue
+    /// \param   Queue      The queue with these properties
+    /// \return  Any of the OpenCL cl::CommandQueue error code
+    /// \brief   This function returns the queue with the given properties
+    /// \details The queue is created on first request. The returned pointer
+    ///          stays valid as long as the runtime lives.
+    ///
+    cl_int GetQueue(cl_command_queue_properties Properties, cl::CommandQueue *& Queue) {
+        std::lock_guard<std::mutex> Lock(mMutex);
+
+        std::map<cl_command_queue_properties, cl::CommandQueue>::iterator it;
+        it = mQueues.find(Properties);
+        if (it == mQueues.end()) {
+            cl_int Error;
+            cl::CommandQueue Created(mContext, mDevices.at(mDevice), Properties, &Error);
+            if (Error != CL_SUCCESS) {
+                return Error;
+            }
+
+            it = mQueues.insert(std::make_pair(Properties, Created)).first;
+        }
+
+        Queue = &it->second;
+
+        return CL_SUCCESS;
+    }
+
+    ///
+    /// \fn      AddQueue
+    /// \param   Properties Properties of the queue
+    /// \param   Created    A queue already created on the used device
+    /// \return  The shared queue with these properties
+    /// \brief   This function shares a queue created before the runtime
+    /// \details If a queue with these properties already exists, it is kept.
+    ///
+    cl::CommandQueue * AddQueue(cl_command_queue_properties Properties,
+                                const cl::CommandQueue & Created) {
+        std::lock_guard<std::mutex> Lock(mMutex);
+        return &mQueues.insert(std::make_pair(Properties, Created)).first->second;
+    }
+
+    ///
+    /// \fn      GetPrograms
+    /// \return  The cache of the programs built in the context
+    ///
+    ProgramCache & GetPrograms() {
+        return mPrograms;
+    }
+
+    ///
+    /// \fn      GetBuffers
+    /// \return  The pool of the buffers released in the context
+    ///
+    BufferPool & GetBuffers() {
+        return mBuffers;
+    }
+};
+}
+
+#endif
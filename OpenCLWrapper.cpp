@@ -1,27 +1,1935 @@
 #include "OpenCL.hpp"
 #include <sys/types.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <libxml/parser.h>
 #include <libxml/tree.h>
 #include <libxml/xpath.h>
 #include <libxml/xpathInternals.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
 #include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <system_error>
+#include <thread>
 
+///
+/// \enum   ArgumentKinds
+/// \brief  Enumeration for all the kernel arguments a config file can declare
+///
+enum ArgumentKinds {
+    BufferArgument, ///< A buffer declared in the config file
+    ScalarArgument, ///< A value of a given type
+    LocalArgument   ///< Local memory of a given size
+};
+
+///
+/// \struct BufferDef
+/// \brief  Buffer declared in the config file
+///
+struct BufferDef {
+    /// Name of the buffer, used by the arguments
+    std::string Name;
+    /// Type of the elements
+    std::string Type;
+    /// Number of elements
+    size_t      Size;
+    /// Size of the buffer, in bytes
+    size_t      Bytes;
+    /// Initial content: zero, index, random or constant
+    std::string Init;
+    /// Value of the elements, for constant
+    double      Value;
+    /// File the content is read from, raw or .npy, empty if none
+    std::string File;
+    /// Offset of the elements in File, in bytes
+    size_t      Offset;
+    /// File the content is written to once run, raw or .npy, empty if none
+    std::string Output;
+    /// The buffer on the device
+    cl::Buffer  Buffer;
+};
+
+///
+/// \struct ArgumentDef
+/// \brief  Kernel argument declared in the config file
+///
+struct ArgumentDef {
+    /// Kind of the argument, see ArgumentKinds
+    unsigned int      Kind;
+    /// Index of the buffer, for buffer arguments
+    size_t            Buffer;
+    /// Value, as bytes, for scalar arguments
+    std::vector<char> Value;
+    /// Size in bytes, for local arguments
+    size_t            LocalSize;
+};
+
+///
+/// \struct KernelDef
+/// \brief  Kernel declared in the config file, and how to run it
+///
 struct KernelDef {
+    /// Identifier of the kernel in the pipeline, its name by default
+    std::string    Id;
+    /// Name of the kernel
     std::string    Name;
+    /// File containing the source of the kernel
     std::string    File;
+    /// Arguments of the kernel, in order
+    std::vector<ArgumentDef> Arguments;
+    /// Number of work-items
+    cl::NDRange    GlobalSize;
+    /// Number of work-items per work-group, cl::NullRange to let OpenCL choose
+    cl::NDRange    LocalSize;
+    /// Indices of the kernels that have to be done before this one
+    std::vector<size_t> After;
+    /// The built kernel
+    cl::Kernel     Kernel;
+};
+
+///
+/// \struct PipelineDef
+/// \brief  Kernels declared in the config file, with the buffers they share
+/// \details A config with a kernel root is a pipeline of a single kernel.
+///
+struct PipelineDef {
+    /// Type of the target device
+    cl_device_type Target;
+    /// Buffers shared by the kernels
+    std::vector<BufferDef> Buffers;
+    /// Kernels, each one only depending on the previous ones
+    std::vector<KernelDef> Kernels;
+    /// Number of runs that aren't measured
+    unsigned int   WarmUp;
+    /// Number of measured runs
+    unsigned int   Iterations;
+};
+
+///
+/// \struct SweepPoint
+/// \brief  Values of the swept parameters for a single run
+/// \details Empty values aren't swept. Values replace ${size} and ${local}
+///          in the config file, and each define replaces ${NAME} and is
+///          passed to the build as -D NAME=VALUE.
+///
+struct SweepPoint {
+    /// Type of the target device, 0 if not swept
     cl_device_type Target;
+    /// Name of the target device type, as in the config file
+    std::string    TargetName;
+    /// Data size
+    std::string    Size;
+    /// Local size
+    std::string    Local;
+    /// Defines, as name and value
+    std::vector<std::pair<std::string, std::string> > Defines;
+};
+
+///
+/// \struct SweepOptions
+/// \brief  How the results of a sweep are output
+///
+struct SweepOptions {
+    /// Whether the config file has a sweep node
+    bool        Enabled;
+    /// File in which the table is written, stdout if empty
+    std::string Output;
+    /// Whether the table is written as JSON, CSV otherwise
+    bool        Json;
+};
+
+///
+/// \struct TuneOptions
+/// \brief  Build flags to tune and how their results are validated
+///
+struct TuneOptions {
+    /// Whether the config file has a tune node
+    bool                     Enabled;
+    /// Maximum error against the results built without flag
+    double                   Tolerance;
+    /// Flags, all their combinations are built
+    std::vector<std::string> Flags;
+};
+
+///
+/// \struct TypeDef
+/// \brief  Type supported for buffers and scalar arguments
+///
+struct TypeDef {
+    /// Name of the type, as in OpenCL C
+    const char * Name;
+    /// Size of the type, in bytes
+    size_t       Size;
+    /// Stores a value written as text, returns false if it isn't valid
+    bool (*Store)(const std::string & Text, char * Value);
+    /// Fills elements with a pattern, returns false if it isn't known
+    bool (*Fill)(const std::string & Init, double Value, size_t Size, std::mt19937 & Generator,
+                 char * Elements);
+    /// Compares elements to reference ones, returns the number of mismatches
+    size_t (*Compare)(const char * Reference, const char * Elements, size_t Size, double Tolerance,
+                      double & MaxError);
+};
+
+///
+/// \fn     StoreValue
+/// \tparam T    Type of the value
+/// \tparam Wide Type the text is read as, so that chars are read as numbers
+/// \param  Text  The value, as text
+/// \param  Value Where the value is stored
+/// \return true in case of success, false otherwise
+/// \details Integers out of the range of T are rejected, and so are signed
+///          values for unsigned types, which streams would wrap.
+///
+template<typename T, typename Wide>
+static bool StoreValue(const std::string & Text, char * Value) {
+    std::istringstream Stream(Text);
+    Wide Read;
+
+    Stream >> std::ws;
+    if (!std::numeric_limits<Wide>::is_signed && (Stream.peek() == '-' || Stream.peek() == '+')) {
+        return false;
+    }
+
+    if (!(Stream >> Read) || !(Stream >> std::ws).eof()) {
+        return false;
+    }
+
+    if (std::numeric_limits<T>::is_integer &&
+        (Read < static_cast<Wide>(std::numeric_limits<T>::min()) ||
+         Read > static_cast<Wide>(std::numeric_limits<T>::max()))) {
+        return false;
+    }
+
+    T Stored = static_cast<T>(Read);
+    std::copy(reinterpret_cast<const char *>(&Stored),
+              reinterpret_cast<const char *>(&Stored) + sizeof(T), Value);
+
+    return true;
+}
+
+///
+/// \fn     FillElements
+/// \tparam T        Type of the elements
+/// \param  Init     Pattern: zero, index, random or constant
+/// \param  Value    Value of the elements, for constant
+/// \param  Size      Number of elements
+/// \param  Generator Generator of the random values
+/// \param  Elements  Where the elements are stored
+/// \return true in case of success, false if the pattern isn't known
+/// \brief  This function initializes the elements of a buffer
+/// \details Random values are in [0, 1) for floating point types and in
+///          [0, 100) for integer types. They only depend on the seed of the
+///          generator, so they are the same from run to run.
+///
+template<typename T>
+static bool FillElements(const std::string & Init, double Value, size_t Size, std::mt19937 & Generator,
+                         char * Elements) {
+    T * Typed = reinterpret_cast<T *>(Elements);
+
+    for (size_t i = 0; i < Size; i++) {
+        if (Init.compare("zero") == 0) {
+            Typed[i] = T(0);
+        } else if (Init.compare("index") == 0) {
+            Typed[i] = static_cast<T>(i);
+        } else if (Init.compare("constant") == 0) {
+            Typed[i] = static_cast<T>(Value);
+        } else if (Init.compare("random") == 0) {
+            Typed[i] = (std::numeric_limits<T>::is_integer ? static_cast<T>(Generator() % 100) :
+                                                             static_cast<T>((Generator() >> 8) / 16777216.0));
+        } else {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+///
+/// \fn     CompareElements
+/// \tparam T         Type of the elements
+/// \param  Reference The expected elements
+/// \param  Elements  The elements to check
+/// \param  Size      Number of elements
+/// \param  Tolerance Maximum error of an element
+/// \param  MaxError  The largest error found
+/// \return The number of elements of which error is above the tolerance
+/// \details The error is absolute for values below 1 and relative above.
+///          Integer elements and NaNs have to match exactly.
+///
+template<typename T>
+static size_t CompareElements(const char * Reference, const char * Elements, size_t Size,
+                              double Tolerance, double & MaxError) {
+    const T * Expected = reinterpret_cast<const T *>(Reference);
+    const T * Typed = reinterpret_cast<const T *>(Elements);
+    size_t Mismatches = 0;
+
+    MaxError = 0.0;
+    for (size_t i = 0; i < Size; i++) {
+        double Error = 0.0;
+
+        if (Typed[i] == Expected[i]) {
+            continue;
+        }
+
+        if (std::numeric_limits<T>::is_integer || Typed[i] != Typed[i] || Expected[i] != Expected[i]) {
+            Error = std::numeric_limits<double>::infinity();
+        } else {
+            Error = std::fabs(static_cast<double>(Typed[i]) - static_cast<double>(Expected[i])) /
+                    std::max(1.0, std::fabs(static_cast<double>(Expected[i])));
+        }
+
+        if (!(Error <= Tolerance)) {
+            Mismatches++;
+        }
+        MaxError = std::max(MaxError, Error);
+    }
+
+    return Mismatches;
+}
+
+///
+/// \var    Types
+/// \brief  All the types supported for buffers and scalar arguments
+///
+static const TypeDef Types[] = {
+    { "char",   sizeof(cl_char),   StoreValue<cl_char, long long>,            FillElements<cl_char>,   CompareElements<cl_char>   },
+    { "uchar",  sizeof(cl_uchar),  StoreValue<cl_uchar, unsigned long long>,  FillElements<cl_uchar>,  CompareElements<cl_uchar>  },
+    { "short",  sizeof(cl_short),  StoreValue<cl_short, long long>,           FillElements<cl_short>,  CompareElements<cl_short>  },
+    { "ushort", sizeof(cl_ushort), StoreValue<cl_ushort, unsigned long long>, FillElements<cl_ushort>, CompareElements<cl_ushort> },
+    { "int",    sizeof(cl_int),    StoreValue<cl_int, long long>,             FillElements<cl_int>,    CompareElements<cl_int>    },
+    { "uint",   sizeof(cl_uint),   StoreValue<cl_uint, unsigned long long>,   FillElements<cl_uint>,   CompareElements<cl_uint>   },
+    { "long",   sizeof(cl_long),   StoreValue<cl_long, long long>,            FillElements<cl_long>,   CompareElements<cl_long>   },
+    { "ulong",  sizeof(cl_ulong),  StoreValue<cl_ulong, unsigned long long>,  FillElements<cl_ulong>,  CompareElements<cl_ulong>  },
+    { "float",  sizeof(cl_float),  StoreValue<cl_float, double>,              FillElements<cl_float>,  CompareElements<cl_float>  },
+    { "double", sizeof(cl_double), StoreValue<cl_double, double>,             FillElements<cl_double>, CompareElements<cl_double> }
+};
+
+///
+/// \fn     FindType
+/// \param  Name Name of the type, as in OpenCL C
+/// \return The type, 0 if it isn't supported
+///
+static const TypeDef * FindType(const std::string & Name) {
+    for (size_t i = 0; i < sizeof(Types) / sizeof(Types[0]); i++) {
+        if (Name.compare(Types[i].Name) == 0) {
+            return &Types[i];
+        }
+    }
+
+    return 0;
+}
+
+///
+/// \fn     PrintUsage
+/// \param  ProgName Name of the executable being run
+/// \return 0
+/// \brief  This function displays the information line about how to use the program
+///
+static int PrintUsage(const char * ProgName) {
+    std::cout << ProgName << ": ConfigFile" << std::endl;
+    return 0;
+}
+
+///
+/// \fn     GetXmlString
+/// \param  XmlContext The XPath context of the config file
+/// \param  Expression XPath expression to evaluate as a string
+/// \param  Value      The value of the expression, left untouched if empty
+/// \return true if the value isn't empty, false otherwise
+///
+static bool GetXmlString(xmlXPathContextPtr XmlContext, const char * Expression, std::string & Value) {
+    bool Found = false;
+
+    xmlXPathObjectPtr XmlObject = xmlXPathEval(BAD_CAST Expression, XmlContext);
+    if ((XmlObject != 0) && ((XmlObject->type == XPATH_STRING) &&
+        (XmlObject->stringval != NULL) && (XmlObject->stringval[0] != 0))) {
+        Value = reinterpret_cast<const char*>(XmlObject->stringval);
+        Found = true;
+    }
+
+    if (XmlObject) {
+        xmlXPathFreeObject(XmlObject);
+    }
+
+    return Found;
+}
+
+///
+/// \fn     GetXmlProperty
+/// \param  Node The XML node
+/// \param  Name Name of the attribute
+/// \return The value of the attribute, empty if it isn't set
+///
+static std::string GetXmlProperty(xmlNodePtr Node, const char * Name) {
+    std::string Value;
+
+    xmlChar * Property = xmlGetProp(Node, BAD_CAST Name);
+    if (Property != NULL) {
+        Value = reinterpret_cast<const char*>(Property);
+        xmlFree(Property);
+    }
+
+    return Value;
+}
+
+///
+/// \fn     GetXmlNodes
+/// \param  XmlContext The XPath context of the config file
+/// \param  Expression XPath expression selecting nodes
+/// \param  Nodes      The selected nodes, in document order
+///
+static void GetXmlNodes(xmlXPathContextPtr XmlContext, const char * Expression,
+                        std::vector<xmlNodePtr> & Nodes) {
+    Nodes.clear();
+
+    xmlXPathObjectPtr XmlObject = xmlXPathEval(BAD_CAST Expression, XmlContext);
+    if ((XmlObject != 0) && (XmlObject->type == XPATH_NODESET) && (XmlObject->nodesetval != NULL)) {
+        for (int i = 0; i < XmlObject->nodesetval->nodeNr; i++) {
+            Nodes.push_back(XmlObject->nodesetval->nodeTab[i]);
+        }
+    }
+
+    if (XmlObject) {
+        xmlXPathFreeObject(XmlObject);
+    }
+}
+
+///
+/// \fn     Substitute
+/// \param  Text  Text in which swept parameters are replaced
+/// \param  Point Values of the swept parameters
+/// \return The text with ${size}, ${local} and ${NAME} of each define replaced
+///
+static std::string Substitute(std::string Text, const SweepPoint & Point) {
+    std::vector<std::pair<std::string, std::string> > Variables = Point.Defines;
+    Variables.push_back(std::make_pair(std::string("size"), Point.Size));
+    Variables.push_back(std::make_pair(std::string("local"), Point.Local));
+
+    for (size_t i = 0; i < Variables.size(); i++) {
+        std::string Name = "${" + Variables[i].first + "}";
+        size_t Found;
+
+        while ((Found = Text.find(Name)) != std::string::npos) {
+            Text.replace(Found, Name.size(), Variables[i].second);
+        }
+    }
+
+    return Text;
+}
+
+///
+/// \fn     ParseRange
+/// \param  Text  Sizes of up to 3 dimensions, separated by commas or spaces
+/// \param  Range The parsed range
+/// \return true in case of success, false otherwise
+///
+static bool ParseRange(std::string Text, cl::NDRange & Range) {
+    std::replace(Text.begin(), Text.end(), ',', ' ');
+
+    std::istringstream Stream(Text);
+    std::vector<size_t> Sizes;
+    size_t Size;
+
+    while (Stream >> Size) {
+        Sizes.push_back(Size);
+    }
+
+    if (!Stream.eof() || Sizes.empty() || Sizes.size() > 3 ||
+        std::find(Sizes.begin(), Sizes.end(), 0) != Sizes.end()) {
+        return false;
+    }
+
+    switch (Sizes.size()) {
+        case 1:
+            Range = cl::NDRange(Sizes[0]);
+            break;
+        case 2:
+            Range = cl::NDRange(Sizes[0], Sizes[1]);
+            break;
+        default:
+            Range = cl::NDRange(Sizes[0], Sizes[1], Sizes[2]);
+            break;
+    }
+
+    return true;
+}
+
+
+///
+/// \fn     IsNumpyFile
+/// \param  Path Path of the file
+/// \return true if the file is a NumPy .npy file, false if it is raw
+///
+static bool IsNumpyFile(const std::string & Path) {
+    return (Path.size() > 4 && Path.compare(Path.size() - 4, 4, ".npy") == 0);
+}
+
+///
+/// \fn     GetNumpyType
+/// \param  Type The type of the elements
+/// \return The NumPy descriptor of the type, such as <f4
+/// \details Elements are stored with the byte order of the host, which is
+///          assumed to be little-endian.
+///
+static std::string GetNumpyType(const TypeDef & Type) {
+    std::string Name = Type.Name;
+    char Kind = ((Name == "float" || Name == "double") ? 'f' : (Name[0] == 'u' ? 'u' : 'i'));
+
+    return (Type.Size == 1 ? "|" : "<") + std::string(1, Kind) + std::to_string(Type.Size);
+}
+
+///
+/// \fn     GetNumpyHeader
+/// \param  Type     The type of the elements
+/// \param  Elements Number of elements
+/// \return The header of a version 1.0 .npy file of a 1-D array
+///
+static std::string GetNumpyHeader(const TypeDef & Type, size_t Elements) {
+    std::string Header = "{'descr': '" + GetNumpyType(Type) + "', 'fortran_order': False, 'shape': (" +
+                         std::to_string(Elements) + ",), }";
+
+    //
+    // The header is padded with spaces so that the data is 64 bytes aligned
+    //
+    Header.append(63 - (10 + Header.size()) % 64, ' ');
+    Header.append(1, '\n');
+
+    std::string Preamble("\x93NUMPY\x01\x00", 8);
+    Preamble.append(1, static_cast<char>(Header.size() & 0xFF));
+    Preamble.append(1, static_cast<char>(Header.size() >> 8));
+
+    return Preamble + Header;
+}
+
+///
+/// \fn     GetDataFile
+/// \param  Path     Path of the file, raw or .npy
+/// \param  Type     The type of the elements
+/// \param  Offset   Offset of the elements in the file, in bytes
+/// \param  Elements Number of elements in the file
+/// \return true in case of success, false otherwise
+/// \brief  This function checks a data file and locates its elements
+/// \details A raw file only holds elements. The type of the elements of a
+///          .npy file has to match, and multi-dimensional arrays have to be
+///          in C order, as they are read as a flat array.
+///
+static bool GetDataFile(const std::string & Path, const TypeDef & Type, size_t & Offset, size_t & Elements) {
+    std::ifstream File(Path.c_str(), std::ios::binary);
+    struct stat stbuf;
+
+    if (!File.is_open() || stat(Path.c_str(), &stbuf) != 0) {
+        std::cout << "Data file " << Path << " could not be opened" << std::endl;
+        return false;
+    }
+
+    size_t FileSize = static_cast<size_t>(stbuf.st_size);
+    Offset = 0;
+
+    if (IsNumpyFile(Path)) {
+        char Preamble[12];
+        size_t Length;
+
+        if (!File.read(Preamble, 10) || std::string(Preamble, 6) != std::string("\x93NUMPY", 6)) {
+            std::cout << "Data file " << Path << " isn't a .npy file" << std::endl;
+            return false;
+        }
+
+        if (Preamble[6] == 1) {
+            Length = static_cast<unsigned char>(Preamble[8]) | (static_cast<unsigned char>(Preamble[9]) << 8);
+            Offset = 10;
+        } else {
+            if (!File.read(Preamble + 10, 2)) {
+                std::cout << "Data file " << Path << " isn't a .npy file" << std::endl;
+                return false;
+            }
+
+            Length = 0;
+            for (int i = 11; i >= 8; i--) {
+                Length = (Length << 8) | static_cast<unsigned char>(Preamble[i]);
+            }
+            Offset = 12;
+        }
+
+        std::string Header(Length, '\0');
+        if (Length == 0 || !File.read(&Header[0], Length)) {
+            std::cout << "Data file " << Path << " has a truncated header" << std::endl;
+            return false;
+        }
+        Offset += Length;
+
+        //
+        // Only the descr, fortran_order and shape keys are looked for
+        //
+        size_t Descr = Header.find("'descr':");
+        size_t Begin = (Descr == std::string::npos ? Descr : Header.find('\'', Descr + 8));
+        size_t End = (Begin == std::string::npos ? Begin : Header.find('\'', Begin + 1));
+        std::string Expected = GetNumpyType(Type);
+        std::string Found = (End == std::string::npos ? "" : Header.substr(Begin + 1, End - Begin - 1));
+
+        if (Found.size() < 2 || Found.substr(1) != Expected.substr(1) ||
+            (Found[0] != Expected[0] && Found[0] != '=' && Found[0] != '|')) {
+            std::cout << "Data file " << Path << " holds " << Found << " instead of " << Expected << std::endl;
+            return false;
+        }
+
+        Begin = Header.find("'shape':");
+        Begin = (Begin == std::string::npos ? Begin : Header.find('(', Begin));
+        End = (Begin == std::string::npos ? Begin : Header.find(')', Begin));
+        if (End == std::string::npos) {
+            std::cout << "Data file " << Path << " has no shape" << std::endl;
+            return false;
+        }
+
+        std::string Shape = Header.substr(Begin + 1, End - Begin - 1);
+        std::replace(Shape.begin(), Shape.end(), ',', ' ');
+        std::istringstream Stream(Shape);
+        size_t Dimension, Dimensions = 0;
+
+        Elements = 1;
+        while (Stream >> Dimension) {
+            Elements *= Dimension;
+            Dimensions++;
+        }
+
+        if (Dimensions > 1 && Header.find("'fortran_order': True") != std::string::npos) {
+            std::cout << "Data file " << Path << " is in Fortran order" << std::endl;
+            return false;
+        }
+    } else {
+        Elements = FileSize / Type.Size;
+    }
+
+    if (Offset > FileSize || (FileSize - Offset) / Type.Size < Elements) {
+        std::cout << "Data file " << Path << " is truncated" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+///
+/// \fn     ParseBuffers
+/// \param  XmlContext The XPath context of the config file
+/// \param  Root       XPath of the root node
+/// \param  Point      Values of the swept parameters
+/// \param  Pipeline   The pipeline to which buffers are added
+/// \return true in case of success, false otherwise
+/// \brief  This function reads the buffer nodes
+/// \details A buffer has a name, a type, a number of elements and an initial
+///          content: zero (default), index, random or constant, with the
+///          value attribute. With the file attribute, the content is read
+///          from a raw or .npy file instead, and the number of elements
+///          defaults to the one of the file. With the output attribute, the
+///          content is written to a raw or .npy file once run.
+///
+static bool ParseBuffers(xmlXPathContextPtr XmlContext, const std::string & Root,
+                         const SweepPoint & Point, PipelineDef & Pipeline) {
+    std::vector<xmlNodePtr> Nodes;
+    GetXmlNodes(XmlContext, (Root + "/buffer").c_str(), Nodes);
+
+    for (size_t i = 0; i < Nodes.size(); i++) {
+        BufferDef Buffer;
+        Buffer.Name = GetXmlProperty(Nodes[i], "name");
+        Buffer.Type = GetXmlProperty(Nodes[i], "type");
+
+        const TypeDef * Type = FindType(Buffer.Type);
+        if (Buffer.Name.empty() || Type == 0) {
+            std::cout << "Buffer " << i << " has no name or an unknown type" << std::endl;
+            return false;
+        }
+
+        //
+        // A buffer read from a file defaults to the size of the file
+        //
+        size_t Elements = 0;
+        std::string Size = Substitute(GetXmlProperty(Nodes[i], "size"), Point);
+        Buffer.File = Substitute(GetXmlProperty(Nodes[i], "file"), Point);
+        Buffer.Output = Substitute(GetXmlProperty(Nodes[i], "output"), Point);
+        Buffer.Offset = 0;
+        if (!Buffer.File.empty() && !GetDataFile(Buffer.File, *Type, Buffer.Offset, Elements)) {
+            return false;
+        }
+
+        if (!Buffer.File.empty() && Size.empty()) {
+            Buffer.Size = Elements;
+        } else if (!StoreValue<size_t, unsigned long long>(Size, reinterpret_cast<char *>(&Buffer.Size))) {
+            Buffer.Size = 0;
+        }
+
+        if (Buffer.Size == 0 || Buffer.Size > std::numeric_limits<size_t>::max() / Type->Size ||
+            (!Buffer.File.empty() && Buffer.Size > Elements)) {
+            std::cout << "Buffer " << Buffer.Name << " has an incorrect size" << std::endl;
+            return false;
+        }
+
+        Buffer.Init = GetXmlProperty(Nodes[i], "init");
+        Buffer.Value = 0.0;
+        if (Buffer.Init.empty()) {
+            Buffer.Init = "zero";
+        } else if (Buffer.Init.compare("constant") == 0 &&
+                   !StoreValue<double, double>(Substitute(GetXmlProperty(Nodes[i], "value"), Point),
+                                               reinterpret_cast<char *>(&Buffer.Value))) {
+            std::cout << "Buffer " << Buffer.Name << " has an incorrect value" << std::endl;
+            return false;
+        }
+
+        //
+        // Check the init on a single element, the content is only filled when run
+        //
+        std::vector<char> Element(Type->Size);
+        std::mt19937 Generator;
+        if (!Type->Fill(Buffer.Init, Buffer.Value, 1, Generator, &Element[0])) {
+            std::cout << "Buffer " << Buffer.Name << " has an unknown init" << std::endl;
+            return false;
+        }
+
+        Buffer.Bytes = Buffer.Size * Type->Size;
+
+        Pipeline.Buffers.push_back(Buffer);
+    }
+
+    return true;
+}
+
+///
+/// \fn     ParseArguments
+/// \param  XmlContext The XPath context of the config file, on the kernel node
+/// \param  Point      Values of the swept parameters
+/// \param  Pipeline   The pipeline, of which buffers are used
+/// \param  Kernel     The kernel to which arguments are added
+/// \return true in case of success, false otherwise
+/// \brief  This function reads the arg nodes, in order
+/// \details An argument is either a declared buffer (buffer attribute), a
+///          value of a given type (type and value attributes), or local
+///          memory (type="local" and size in bytes).
+///
+static bool ParseArguments(xmlXPathContextPtr XmlContext, const SweepPoint & Point,
+                           const PipelineDef & Pipeline, KernelDef & Kernel) {
+    std::vector<xmlNodePtr> Nodes;
+    GetXmlNodes(XmlContext, "arg", Nodes);
+
+    for (size_t i = 0; i < Nodes.size(); i++) {
+        ArgumentDef Argument;
+        std::string Buffer = GetXmlProperty(Nodes[i], "buffer");
+        std::string Type = GetXmlProperty(Nodes[i], "type");
+        bool Valid = false;
+
+        if (!Buffer.empty()) {
+            Argument.Kind = BufferArgument;
+            for (size_t j = 0; j < Pipeline.Buffers.size() && !Valid; j++) {
+                if (Pipeline.Buffers[j].Name == Buffer) {
+                    Argument.Buffer = j;
+                    Valid = true;
+                }
+            }
+        } else if (Type.compare("local") == 0) {
+            Argument.Kind = LocalArgument;
+            Valid = (StoreValue<size_t, unsigned long long>(Substitute(GetXmlProperty(Nodes[i], "size"), Point),
+                                                            reinterpret_cast<char *>(&Argument.LocalSize)) &&
+                     Argument.LocalSize != 0);
+        } else if (FindType(Type) != 0) {
+            const TypeDef * Scalar = FindType(Type);
+            Argument.Kind = ScalarArgument;
+            Argument.Value.resize(Scalar->Size);
+            Valid = Scalar->Store(Substitute(GetXmlProperty(Nodes[i], "value"), Point), &Argument.Value[0]);
+        }
+
+        if (!Valid) {
+            std::cout << "Argument " << i << " of " << Kernel.Id << " is incorrect" << std::endl;
+            return false;
+        }
+
+        Kernel.Arguments.push_back(Argument);
+    }
+
+    return true;
+}
+
+///
+/// \fn     ParseKernel
+/// \param  XmlContext The XPath context of the config file
+/// \param  Node       The kernel node
+/// \param  File       File containing the kernel, unless the node sets one
+/// \param  Point      Values of the swept parameters
+/// \param  Pipeline   The pipeline to which the kernel is added
+/// \return true in case of success, false otherwise
+/// \brief  This function reads a kernel node
+/// \details The kernel name and the global size are required, the local
+///          size is optional. The after attribute lists the identifiers
+///          of the kernels that have to be done first, separated by spaces
+///          or commas. They have to be declared before.
+///
+static bool ParseKernel(xmlXPathContextPtr XmlContext, xmlNodePtr Node, const std::string & File,
+                        const SweepPoint & Point, PipelineDef & Pipeline) {
+    KernelDef Kernel;
+    std::string Value;
+
+    XmlContext->node = Node;
+
+    //
+    // Get the kernel file and name
+    //
+    Kernel.File = File;
+    GetXmlString(XmlContext, "string(@file)", Kernel.File);
+
+    //
+    // Ensure that file name is correct and that the file exists
+    //
+    struct stat stbuf;
+    if (Kernel.File == "") {
+        std::cout << "Kernel file name was not provided" << std::endl;
+        return false;
+    }
+
+    if (stat(Kernel.File.c_str(), &stbuf) != 0) {
+        std::cout << "Kernel file was incorrect" << std::endl;
+        return false;
+    }
+
+    //
+    // Ensure that kernel name is not empty
+    //
+    if (!GetXmlString(XmlContext, "string(@name)", Kernel.Name)) {
+        std::cout << "Kernel name was not provided" << std::endl;
+        return false;
+    }
+
+    Kernel.Id = Kernel.Name;
+    GetXmlString(XmlContext, "string(@id)", Kernel.Id);
+    for (size_t i = 0; i < Pipeline.Kernels.size(); i++) {
+        if (Pipeline.Kernels[i].Id == Kernel.Id) {
+            std::cout << "Kernel " << Kernel.Id << " is declared twice" << std::endl;
+            return false;
+        }
+    }
+
+    //
+    // Get the dependencies, among the kernels already declared
+    //
+    if (GetXmlString(XmlContext, "string(@after)", Value)) {
+        std::replace(Value.begin(), Value.end(), ',', ' ');
+        std::istringstream Stream(Value);
+        std::string Id;
+
+        while (Stream >> Id) {
+            size_t Found = Pipeline.Kernels.size();
+            for (size_t i = 0; i < Pipeline.Kernels.size(); i++) {
+                if (Pipeline.Kernels[i].Id == Id) {
+                    Found = i;
+                }
+            }
+
+            if (Found == Pipeline.Kernels.size()) {
+                std::cout << "Kernel " << Kernel.Id << " depends on " << Id
+                          << ", which isn't declared before" << std::endl;
+                return false;
+            }
+
+            Kernel.After.push_back(Found);
+        }
+    }
+
+    if (!ParseArguments(XmlContext, Point, Pipeline, Kernel)) {
+        return false;
+    }
+
+    //
+    // Get the range
+    //
+    if (!GetXmlString(XmlContext, "string(range/@global)", Value) ||
+        !ParseRange(Substitute(Value, Point), Kernel.GlobalSize)) {
+        std::cout << "Global size of " << Kernel.Id << " is missing or incorrect" << std::endl;
+        return false;
+    }
+
+    Kernel.LocalSize = cl::NullRange;
+    if (GetXmlString(XmlContext, "string(range/@local)", Value) &&
+        (!ParseRange(Substitute(Value, Point), Kernel.LocalSize) ||
+         Kernel.LocalSize.dimensions() != Kernel.GlobalSize.dimensions())) {
+        std::cout << "Local size of " << Kernel.Id << " is incorrect" << std::endl;
+        return false;
+    }
+
+    Pipeline.Kernels.push_back(Kernel);
+
+    return true;
+}
+
+///
+/// \fn     ParseRun
+/// \param  XmlContext The XPath context of the config file
+/// \param  Root       XPath of the root node
+/// \param  Pipeline   The pipeline of which the run is defined
+/// \return true in case of success, false otherwise
+/// \brief  This function reads the run node
+/// \details By default, the pipeline is run 3 times for warm-up and 10
+///          times for measurement.
+///
+static bool ParseRun(xmlXPathContextPtr XmlContext, const std::string & Root,
+                     PipelineDef & Pipeline) {
+    std::string Value;
+
+    Pipeline.WarmUp = 3;
+    if (GetXmlString(XmlContext, ("string(" + Root + "/run/@warmup)").c_str(), Value) &&
+        !StoreValue<unsigned int, unsigned long>(Value, reinterpret_cast<char *>(&Pipeline.WarmUp))) {
+        std::cout << "Warm-up count is incorrect" << std::endl;
+        return false;
+    }
+
+    Pipeline.Iterations = 10;
+    if (GetXmlString(XmlContext, ("string(" + Root + "/run/@iterations)").c_str(), Value) &&
+        (!StoreValue<unsigned int, unsigned long>(Value, reinterpret_cast<char *>(&Pipeline.Iterations)) ||
+         Pipeline.Iterations == 0)) {
+        std::cout << "Iteration count is incorrect" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+///
+/// \fn     ParseTarget
+/// \param  Type   Type of the device: cpu, gpu, accelerator or all
+/// \param  Target The matching device type
+/// \return true if the type is known, false otherwise
+///
+static bool ParseTarget(const std::string & Type, cl_device_type & Target) {
+    if (Type.compare("cpu") == 0) {
+        Target = CL_DEVICE_TYPE_CPU;
+    } else if (Type.compare("gpu") == 0) {
+        Target = CL_DEVICE_TYPE_GPU;
+    } else if (Type.compare("accelerator") == 0) {
+        Target = CL_DEVICE_TYPE_ACCELERATOR;
+    } else if (Type.compare("all") == 0) {
+        Target = CL_DEVICE_TYPE_ALL;
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+///
+/// \fn     GetRoot
+/// \param  XmlContext The XPath context of the config file
+/// \param  Root       XPath of the root node
+/// \param  Nodes      The kernel nodes
+/// \brief  This function finds the root and the kernels of the config file
+/// \details The root is either a pipeline node, with kernel children, or a
+///          single kernel node.
+///
+static void GetRoot(xmlXPathContextPtr XmlContext, std::string & Root, std::vector<xmlNodePtr> & Nodes) {
+    Root = "/pipeline";
+    GetXmlNodes(XmlContext, "/pipeline/kernel", Nodes);
+    if (Nodes.empty()) {
+        Root = "/kernel";
+        GetXmlNodes(XmlContext, "/kernel", Nodes);
+    }
+}
+
+///
+/// \fn     ParsePipeline
+/// \param  XmlContext The XPath context of the config file
+/// \param  Point      Values of the swept parameters
+/// \param  Pipeline   The pipeline declared in the config file
+/// \return true in case of success, false otherwise
+/// \brief  This function reads the whole config file
+/// \details Buffers, target and run are children of the root. Kernels of
+///          a pipeline get their file from the root, unless they set one.
+///          A swept target replaces the target of the config file.
+///
+static bool ParsePipeline(xmlXPathContextPtr XmlContext, const SweepPoint & Point,
+                          PipelineDef & Pipeline) {
+    std::vector<xmlNodePtr> Nodes;
+    std::string Root;
+    std::string File;
+    std::string Type;
+
+    GetRoot(XmlContext, Root, Nodes);
+    if (Nodes.empty()) {
+        std::cout << "No kernel was provided" << std::endl;
+        return false;
+    }
+
+    //
+    // Get target if any
+    //
+    Pipeline.Target = CL_DEVICE_TYPE_ALL;
+    if (Point.Target != 0) {
+        Pipeline.Target = Point.Target;
+    } else if (GetXmlString(XmlContext, ("string(" + Root + "/target/@type)").c_str(), Type)) {
+        ParseTarget(Type, Pipeline.Target);
+    }
+
+    Pipeline.Buffers.clear();
+    Pipeline.Kernels.clear();
+    if (!ParseBuffers(XmlContext, Root, Point, Pipeline) || !ParseRun(XmlContext, Root, Pipeline)) {
+        return false;
+    }
+
+    GetXmlString(XmlContext, ("string(" + Root + "/@file)").c_str(), File);
+    for (size_t i = 0; i < Nodes.size(); i++) {
+        if (!ParseKernel(XmlContext, Nodes[i], File, Point, Pipeline)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+///
+/// \fn     GetSweepValues
+/// \param  Node   The node of a swept parameter
+/// \param  Values The values of the parameter
+/// \return true if there is at least one value, false otherwise
+/// \details Values are separated by spaces or commas.
+///
+static bool GetSweepValues(xmlNodePtr Node, std::vector<std::string> & Values) {
+    std::string Text = GetXmlProperty(Node, "values");
+    std::replace(Text.begin(), Text.end(), ',', ' ');
+
+    std::istringstream Stream(Text);
+    std::string Value;
+
+    Values.clear();
+    while (Stream >> Value) {
+        Values.push_back(Value);
+    }
+
+    return !Values.empty();
+}
+
+///
+/// \fn     ParseSweep
+/// \param  XmlContext The XPath context of the config file
+/// \param  Points     All the combinations of the swept parameters
+/// \param  Options    How the results are output
+/// \return true in case of success, false otherwise
+/// \brief  This function reads the sweep node and builds the cross product
+/// \details The sweep node is a child of the root, with target, size,
+///          local and define children, each with a values attribute. A
+///          define also has a name attribute. Its output attribute sets
+///          the file of the table, and its format attribute is either csv
+///          (default) or json. Without sweep node, there is a single point
+///          with nothing swept.
+///
+static bool ParseSweep(xmlXPathContextPtr XmlContext, std::vector<SweepPoint> & Points,
+                       SweepOptions & Options) {
+    std::vector<xmlNodePtr> Nodes;
+    std::vector<std::string> Values;
+    std::string Root;
+    std::string Format;
+
+    SweepPoint Default;
+    Default.Target = 0;
+    Points.assign(1, Default);
+
+    GetRoot(XmlContext, Root, Nodes);
+    GetXmlNodes(XmlContext, (Root + "/sweep").c_str(), Nodes);
+    Options.Enabled = !Nodes.empty();
+    GetXmlString(XmlContext, ("string(" + Root + "/sweep/@output)").c_str(), Options.Output);
+
+    Options.Json = false;
+    if (GetXmlString(XmlContext, ("string(" + Root + "/sweep/@format)").c_str(), Format)) {
+        Options.Json = (Format.compare("json") == 0);
+        if (!Options.Json && Format.compare("csv") != 0) {
+            std::cout << "Sweep format " << Format << " is unknown" << std::endl;
+            return false;
+        }
+    }
+
+    GetXmlNodes(XmlContext, (Root + "/sweep/*").c_str(), Nodes);
+    for (size_t i = 0; i < Nodes.size(); i++) {
+        std::string Parameter = reinterpret_cast<const char*>(Nodes[i]->name);
+        std::string Name = GetXmlProperty(Nodes[i], "name");
+
+        if (!GetSweepValues(Nodes[i], Values) || (Parameter.compare("define") == 0 && Name.empty())) {
+            std::cout << "Swept " << Parameter << " has no name or no values" << std::endl;
+            return false;
+        }
+
+        std::vector<SweepPoint> Product;
+        for (size_t j = 0; j < Points.size(); j++) {
+            for (size_t k = 0; k < Values.size(); k++) {
+                SweepPoint Point = Points[j];
+
+                if (Parameter.compare("target") == 0) {
+                    Point.TargetName = Values[k];
+                    if (!ParseTarget(Values[k], Point.Target)) {
+                        std::cout << "Swept target " << Values[k] << " is unknown" << std::endl;
+                        return false;
+                    }
+                } else if (Parameter.compare("size") == 0) {
+                    Point.Size = Values[k];
+                } else if (Parameter.compare("local") == 0) {
+                    Point.Local = Values[k];
+                } else if (Parameter.compare("define") == 0) {
+                    Point.Defines.push_back(std::make_pair(Name, Values[k]));
+                } else {
+                    std::cout << "Swept " << Parameter << " is unknown" << std::endl;
+                    return false;
+                }
+
+                Product.push_back(Point);
+            }
+        }
+
+        Points.swap(Product);
+    }
+
+    return true;
+}
+
+///
+/// \fn     ParseTune
+/// \param  XmlContext The XPath context of the config file
+/// \param  Options    The flags to tune and their tolerance
+/// \return true in case of success, false otherwise
+/// \brief  This function reads the tune node
+/// \details The tune node is a child of the root. Its tolerance attribute
+///          defaults to 1e-5 and its flags attribute, separated by spaces,
+///          defaults to the standard OpenCL optimization flags.
+///
+static bool ParseTune(xmlXPathContextPtr XmlContext, TuneOptions & Options) {
+    static const char * DefaultFlags[] = { "-cl-fast-relaxed-math", "-cl-mad-enable",
+                                           "-cl-no-signed-zeros", "-cl-unsafe-math-optimizations" };
+    std::vector<xmlNodePtr> Nodes;
+    std::string Root;
+    std::string Value;
+
+    GetRoot(XmlContext, Root, Nodes);
+    GetXmlNodes(XmlContext, (Root + "/tune").c_str(), Nodes);
+    Options.Enabled = !Nodes.empty();
+
+    Options.Tolerance = 1e-5;
+    if (GetXmlString(XmlContext, ("string(" + Root + "/tune/@tolerance)").c_str(), Value) &&
+        (!StoreValue<double, double>(Value, reinterpret_cast<char *>(&Options.Tolerance)) ||
+         !(Options.Tolerance >= 0.0))) {
+        std::cout << "Tolerance is incorrect" << std::endl;
+        return false;
+    }
+
+    Options.Flags.assign(DefaultFlags, DefaultFlags + sizeof(DefaultFlags) / sizeof(DefaultFlags[0]));
+    if (GetXmlString(XmlContext, ("string(" + Root + "/tune/@flags)").c_str(), Value)) {
+        std::istringstream Stream(Value);
+        std::string Flag;
+
+        Options.Flags.clear();
+        while (Stream >> Flag) {
+            Options.Flags.push_back(Flag);
+        }
+    }
+
+    if (Options.Flags.size() > 10) {
+        std::cout << "Too many flags to tune: " << Options.Flags.size() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+///
+/// \fn     LoadBuffer
+/// \param  OclObject The OpenCL instance
+/// \param  Buffer    The buffer, allocated, to read from its file
+/// \return CL_SUCCESS, CL_INVALID_VALUE or any OpenCL error
+/// \brief  This function initializes a buffer from its data file
+/// \details The file is mapped and copied once, into a pinned staging
+///          buffer from which the device buffer is written.
+///
+static cl_int LoadBuffer(OpenCLWrapper::OpenCL & OclObject, BufferDef & Buffer) {
+    size_t Length = Buffer.Offset + Buffer.Bytes;
+
+    int File = open(Buffer.File.c_str(), O_RDONLY);
+    if (File < 0) {
+        std::cerr << "Could not open: " << Buffer.File << std::endl;
+        return CL_INVALID_VALUE;
+    }
+
+    void * Mapped = mmap(0, Length, PROT_READ, MAP_PRIVATE, File, 0);
+    close(File);
+    if (Mapped == MAP_FAILED) {
+        std::cerr << "Could not map: " << Buffer.File << std::endl;
+        return CL_INVALID_VALUE;
+    }
+    madvise(Mapped, Length, MADV_SEQUENTIAL);
+
+    cl::Buffer Staging;
+    char * Host = 0;
+    cl_int Error = OclObject.AllocatePinnedBuffer<char>(Buffer.Bytes, Staging);
+    if (Error == CL_SUCCESS) {
+        Error = OclObject.MapBuffer<char>(Staging, CL_MAP_WRITE_INVALIDATE_REGION, Buffer.Bytes, Host);
+    }
+
+    if (Error == CL_SUCCESS) {
+        const char * Elements = static_cast<const char *>(Mapped) + Buffer.Offset;
+        std::copy(Elements, Elements + Buffer.Bytes, Host);
+
+        Error = OclObject.WriteBuffer(Buffer.Buffer, Host, Buffer.Bytes);
+
+        cl_int UnmapError = OclObject.UnmapBuffer(Staging, Host);
+        Error = (Error == CL_SUCCESS ? UnmapError : Error);
+    }
+
+    munmap(Mapped, Length);
+
+    return Error;
+}
+
+///
+/// \fn     StoreBuffer
+/// \param  OclObject The OpenCL instance
+/// \param  Buffer    The buffer to write to its output file
+/// \return CL_SUCCESS, CL_INVALID_VALUE or any OpenCL error
+/// \brief  This function writes the content of a buffer to its output file
+/// \details The device buffer is read into a pinned staging buffer, and
+///          copied from there into the mapped output file. A .npy file gets
+///          a 1-D array header.
+///
+static cl_int StoreBuffer(OpenCLWrapper::OpenCL & OclObject, BufferDef & Buffer) {
+    std::string Header;
+    if (IsNumpyFile(Buffer.Output)) {
+        Header = GetNumpyHeader(*FindType(Buffer.Type), Buffer.Size);
+    }
+
+    size_t Length = Header.size() + Buffer.Bytes;
+
+    int File = open(Buffer.Output.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (File < 0) {
+        std::cerr << "Could not open: " << Buffer.Output << std::endl;
+        return CL_INVALID_VALUE;
+    }
+
+    void * Mapped = MAP_FAILED;
+    if (ftruncate(File, static_cast<off_t>(Length)) == 0) {
+        Mapped = mmap(0, Length, PROT_READ | PROT_WRITE, MAP_SHARED, File, 0);
+    }
+    close(File);
+    if (Mapped == MAP_FAILED) {
+        std::cerr << "Could not map: " << Buffer.Output << std::endl;
+        return CL_INVALID_VALUE;
+    }
+
+    cl::Buffer Staging;
+    char * Host = 0;
+    cl_int Error = OclObject.AllocatePinnedBuffer<char>(Buffer.Bytes, Staging);
+    if (Error == CL_SUCCESS) {
+        Error = OclObject.MapBuffer<char>(Staging, CL_MAP_WRITE_INVALIDATE_REGION, Buffer.Bytes, Host);
+    }
+
+    if (Error == CL_SUCCESS) {
+        Error = OclObject.ReadBuffer<char>(Buffer.Buffer, Host, Buffer.Bytes);
+        if (Error == CL_SUCCESS) {
+            std::copy(Header.begin(), Header.end(), static_cast<char *>(Mapped));
+            std::copy(Host, Host + Buffer.Bytes, static_cast<char *>(Mapped) + Header.size());
+        }
+
+        cl_int UnmapError = OclObject.UnmapBuffer(Staging, Host);
+        Error = (Error == CL_SUCCESS ? UnmapError : Error);
+    }
+
+    munmap(Mapped, Length);
+
+    return Error;
+}
+
+///
+/// \fn     PreparePipeline
+/// \param  OclObject The OpenCL instance
+/// \param  Pipeline  The pipeline, of which buffers are allocated and kernels built
+/// \return CL_SUCCESS or any OpenCL error
+/// \brief  This function allocates and initializes the buffers, builds the
+///         kernels and sets their arguments
+///
+static cl_int PreparePipeline(OpenCLWrapper::OpenCL & OclObject, PipelineDef & Pipeline) {
+    cl_int Error;
+
+    for (size_t i = 0; i < Pipeline.Buffers.size(); i++) {
+        BufferDef & Buffer = Pipeline.Buffers[i];
+
+        Error = OclObject.AllocateBuffer<char>(Buffer.Bytes, Buffer.Buffer);
+        if (Error != CL_SUCCESS) {
+            return Error;
+        }
+
+        if (!Buffer.File.empty()) {
+            Error = LoadBuffer(OclObject, Buffer);
+            if (Error != CL_SUCCESS) {
+                return Error;
+            }
+            continue;
+        }
+
+        //
+        // Each buffer has its own seed, so that its content doesn't depend
+        // on the thread or on the buffers filled before
+        //
+        std::vector<char> Content(Buffer.Bytes);
+        std::mt19937 Generator(static_cast<std::mt19937::result_type>(i + 1));
+        FindType(Buffer.Type)->Fill(Buffer.Init, Buffer.Value, Buffer.Size, Generator, &Content[0]);
+
+        Error = OclObject.WriteBuffer(Buffer.Buffer, &Content[0], Buffer.Bytes);
+        if (Error != CL_SUCCESS) {
+            return Error;
+        }
+    }
+
+    for (size_t i = 0; i < Pipeline.Kernels.size(); i++) {
+        KernelDef & Kernel = Pipeline.Kernels[i];
+
+        Error = OclObject.GetKernelFromFile(Kernel.File.c_str(), Kernel.Name.c_str(), Kernel.Kernel);
+        if (Error != CL_SUCCESS) {
+            std::string Log;
+            OclObject.GetLastBuildLog(Log);
+            std::cerr << "Could not build " << Kernel.Id << ": " << Error << std::endl << Log;
+            return Error;
+        }
+
+        for (cl_uint j = 0; j < Kernel.Arguments.size(); j++) {
+            const ArgumentDef & Argument = Kernel.Arguments[j];
+
+            switch (Argument.Kind) {
+                case BufferArgument:
+                    Error = Kernel.Kernel.setArg(j, Pipeline.Buffers[Argument.Buffer].Buffer);
+                    break;
+                case LocalArgument:
+                    Error = Kernel.Kernel.setArg(j, cl::Local(Argument.LocalSize));
+                    break;
+                default:
+                    Error = Kernel.Kernel.setArg(j, Argument.Value.size(), &Argument.Value[0]);
+                    break;
+            }
+
+            if (Error != CL_SUCCESS) {
+                return Error;
+            }
+        }
+    }
+
+    return CL_SUCCESS;
+}
+
+///
+/// \struct PipelineTimes
+/// \brief  Times of the measured runs of a pipeline, in ns
+///
+struct PipelineTimes {
+    /// Device time from the start of the first kernel to the end of the last one
+    std::vector<double> Span;
+    /// Host time from queuing the first kernel to the end of the last one
+    std::vector<double> Host;
+    /// Device time of each kernel
+    std::vector<std::vector<double> > Kernels;
 };
 
 ///
-/// \fn     PrintUsage
-/// \param  ProgName Name of the executable being run
-/// \return 0
-/// \brief  This function displays the information line about how to use the program
+/// \fn     RunPipeline
+/// \param  OclObject The OpenCL instance
+/// \param  Pipeline  The pipeline, with its kernels prepared
+/// \param  Times     Times of the measured runs
+/// \return CL_SUCCESS or any OpenCL error
+/// \brief  This function runs the pipeline with as much overlap as possible
+/// \details Each kernel only waits for the events of the kernels it depends
+///          on, so independent kernels run concurrently if the device can.
+///          Runs are not overlapped, so that they can be measured.
 ///
-static int PrintUsage(const char * ProgName) {
-    std::cout << ProgName << ": ConfigFile" << std::endl;
+static cl_int RunPipeline(OpenCLWrapper::OpenCL & OclObject, const PipelineDef & Pipeline,
+                          PipelineTimes & Times) {
+    Times.Kernels.assign(Pipeline.Kernels.size(), std::vector<double>());
+
+    for (unsigned int i = 0; i < Pipeline.WarmUp + Pipeline.Iterations; i++) {
+        std::vector<cl::Event> Events(Pipeline.Kernels.size());
+        cl_int Error = CL_SUCCESS;
+
+        cl_ulong Begin = OpenCLWrapper::GetHostTime();
+        for (size_t j = 0; j < Pipeline.Kernels.size() && Error == CL_SUCCESS; j++) {
+            const KernelDef & Kernel = Pipeline.Kernels[j];
+            std::vector<cl::Event> WaitList;
+
+            for (size_t k = 0; k < Kernel.After.size(); k++) {
+                WaitList.push_back(Events[Kernel.After[k]]);
+            }
+
+            Error = OclObject.EnqueueKernel(Kernel.Kernel, Kernel.GlobalSize, Kernel.LocalSize,
+                                            WaitList, Events[j]);
+        }
+
+        if (Error == CL_SUCCESS) {
+            Error = OclObject.FlushKernels();
+        }
+
+        if (Error == CL_SUCCESS) {
+            Error = OclObject.WaitForEvents(Events);
+        }
+        cl_ulong End = OpenCLWrapper::GetHostTime();
+
+        if (Error != CL_SUCCESS) {
+            return Error;
+        }
+
+        if (i < Pipeline.WarmUp) {
+            continue;
+        }
+
+        //
+        // The span goes from the first start to the last end
+        //
+        cl_ulong First = 0, Last = 0;
+        for (size_t j = 0; j < Events.size(); j++) {
+            cl_ulong Start, Stop;
+
+            Error = Events[j].getProfilingInfo(CL_PROFILING_COMMAND_START, &Start);
+            if (Error == CL_SUCCESS) {
+                Error = Events[j].getProfilingInfo(CL_PROFILING_COMMAND_END, &Stop);
+            }
+
+            if (Error != CL_SUCCESS) {
+                return Error;
+            }
+
+            First = (j == 0 ? Start : std::min(First, Start));
+            Last = (j == 0 ? Stop : std::max(Last, Stop));
+            Times.Kernels[j].push_back(static_cast<double>(Stop > Start ? Stop - Start : 0));
+        }
+
+        Times.Span.push_back(static_cast<double>(Last - First));
+        Times.Host.push_back(static_cast<double>(End - Begin));
+    }
+
+    return CL_SUCCESS;
+}
+
+///
+/// \fn     GetMedian
+/// \param  Samples Sorted samples of which the median is computed
+/// \return The median of the samples, 0 if empty
+///
+static double GetMedian(const std::vector<double> & Samples) {
+    if (Samples.empty()) {
+        return 0.0;
+    }
+
+    size_t Middle = Samples.size() / 2;
+
+    return ((Samples.size() % 2) ? Samples[Middle] :
+                                   (Samples[Middle - 1] + Samples[Middle]) / 2.0);
+}
+
+///
+/// \fn     GetKernelBytes
+/// \param  Pipeline The pipeline
+/// \param  Kernel   The kernel
+/// \return The bytes of the buffers passed to the kernel
+///
+static double GetKernelBytes(const PipelineDef & Pipeline, const KernelDef & Kernel) {
+    double Bytes = 0.0;
+
+    for (size_t i = 0; i < Kernel.Arguments.size(); i++) {
+        if (Kernel.Arguments[i].Kind == BufferArgument) {
+            Bytes += Pipeline.Buffers[Kernel.Arguments[i].Buffer].Bytes;
+        }
+    }
+
+    return Bytes;
+}
+
+///
+/// \fn     WriteTimes
+/// \param  Label   Label of the row
+/// \param  Samples Times, in ns
+/// \param  Bytes   Bytes accessed, to output bandwidths instead of times, 0 otherwise
+/// \brief  This function outputs min, median and max of the samples
+/// \details The lowest bandwidth comes with the highest time.
+///
+static void WriteTimes(const std::string & Label, std::vector<double> Samples, double Bytes) {
+    std::sort(Samples.begin(), Samples.end());
+    double Values[] = { Samples.front(), GetMedian(Samples), Samples.back() };
+
+    std::cout << std::setw(24) << std::left << Label << std::right;
+    for (unsigned int i = 0; i < 3; i++) {
+        if (Bytes == 0.0) {
+            std::cout << std::setw(14) << Values[i] / 1000.0;
+        } else {
+            std::cout << std::setw(14) << (Values[2 - i] == 0.0 ? 0.0 : Bytes / Values[2 - i]);
+        }
+    }
+    std::cout << std::endl;
+}
+
+///
+/// \fn     WriteReport
+/// \param  Device   Name of the device the pipeline ran on
+/// \param  Pipeline The pipeline
+/// \param  Times    Times of the measured runs
+/// \brief  This function outputs min, median and max times and bandwidths
+/// \details Bandwidth assumes that each buffer argument is accessed once
+///          entirely, and is derived from the device time. For pipelines,
+///          each kernel is also reported, as well as the overlap: the sum
+///          of the median kernel times over the median span.
+///
+static void WriteReport(const std::string & Device, const PipelineDef & Pipeline,
+                        const PipelineTimes & Times) {
+    double Bytes = 0.0;
+    double Busy = 0.0;
+
+    std::cout << "Kernels:    ";
+    for (size_t i = 0; i < Pipeline.Kernels.size(); i++) {
+        const KernelDef & Kernel = Pipeline.Kernels[i];
+        std::cout << (i == 0 ? "" : ", ") << Kernel.Id << " (" << Kernel.File << ")";
+        Bytes += GetKernelBytes(Pipeline, Kernel);
+    }
+    std::cout << std::endl;
+    std::cout << "Device:     " << Device << std::endl;
+    std::cout << "Iterations: " << Pipeline.Iterations << " (" << Pipeline.WarmUp << " warm-up)" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << std::setw(24) << "" << std::setw(14) << "min" << std::setw(14) << "median"
+              << std::setw(14) << "max" << std::endl;
+
+    WriteTimes("Device time (us)", Times.Span, 0.0);
+    WriteTimes("Host time (us)", Times.Host, 0.0);
+    WriteTimes("Bandwidth (GB/s)", Times.Span, Bytes);
+
+    if (Pipeline.Kernels.size() == 1) {
+        return;
+    }
+
+    for (size_t i = 0; i < Pipeline.Kernels.size(); i++) {
+        const KernelDef & Kernel = Pipeline.Kernels[i];
+        std::vector<double> Sorted = Times.Kernels[i];
+
+        WriteTimes(Kernel.Id + " (us)", Sorted, 0.0);
+        WriteTimes(Kernel.Id + " (GB/s)", Sorted, GetKernelBytes(Pipeline, Kernel));
+
+        std::sort(Sorted.begin(), Sorted.end());
+        Busy += GetMedian(Sorted);
+    }
+
+    std::vector<double> Span = Times.Span;
+    std::sort(Span.begin(), Span.end());
+    std::cout << "Overlap:    " << (GetMedian(Span) == 0.0 ? 0.0 : Busy / GetMedian(Span)) << std::endl;
+}
+
+///
+/// \fn     ReadBuffers
+/// \param  OclObject The OpenCL instance
+/// \param  Pipeline  The pipeline that ran
+/// \param  Contents  The content of each buffer
+/// \return CL_SUCCESS or any OpenCL error
+///
+static cl_int ReadBuffers(OpenCLWrapper::OpenCL & OclObject, PipelineDef & Pipeline,
+                          std::vector<std::vector<char> > & Contents) {
+    Contents.resize(Pipeline.Buffers.size());
+
+    for (size_t i = 0; i < Pipeline.Buffers.size(); i++) {
+        BufferDef & Buffer = Pipeline.Buffers[i];
+
+        Contents[i].resize(Buffer.Bytes);
+        cl_int Error = OclObject.ReadBuffer<char>(Buffer.Buffer, &Contents[i][0], Buffer.Bytes);
+        if (Error != CL_SUCCESS) {
+            return Error;
+        }
+    }
+
+    return CL_SUCCESS;
+}
+
+///
+/// \fn     Tune
+/// \param  OclObject The OpenCL instance, with its target set
+/// \param  Pipeline  The pipeline to tune
+/// \param  Options   The flags to tune and their tolerance
+/// \return 0 in case of success, -error otherwise
+/// \brief  This function runs the pipeline built with all the combinations
+///         of flags and reports the fastest one that stays in tolerance
+/// \details The combination without flag runs first and its buffers are
+///          the reference the other combinations are validated against.
+///          Buffers are initialized with the same values for every
+///          combination.
+///
+static int Tune(OpenCLWrapper::OpenCL & OclObject, PipelineDef & Pipeline, const TuneOptions & Options) {
+    std::vector<std::vector<char> > Reference;
+    std::vector<std::vector<char> > Contents;
+    size_t Best = 0;
+    double BestTime = 0.0;
+    double ReferenceTime = 0.0;
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << std::setw(14) << "median (us)" << std::setw(10) << "speedup" << std::setw(14) << "max error"
+              << "  flags" << std::endl;
+
+    for (size_t Combination = 0; Combination < (static_cast<size_t>(1) << Options.Flags.size()); Combination++) {
+        std::string Flags;
+        for (size_t i = 0; i < Options.Flags.size(); i++) {
+            if (Combination & (static_cast<size_t>(1) << i)) {
+                Flags += (Flags.empty() ? "" : " ") + Options.Flags[i];
+            }
+        }
+        OclObject.SetParameter(OpenCLWrapper::BuildOptions, Flags);
+
+        PipelineTimes Times;
+        cl_int Error = PreparePipeline(OclObject, Pipeline);
+        if (Error == CL_SUCCESS) {
+            Error = RunPipeline(OclObject, Pipeline, Times);
+        }
+        if (Error == CL_SUCCESS) {
+            Error = ReadBuffers(OclObject, Pipeline, (Combination == 0 ? Reference : Contents));
+        }
+
+        if (Error != CL_SUCCESS) {
+            std::cout << std::setw(38) << std::left << ("failed: " + std::to_string(Error)) << std::right
+                      << "  " << (Flags.empty() ? "(none)" : Flags) << std::endl;
+            if (Combination == 0) {
+                std::cerr << "Could not run the kernels without flag: " << Error << std::endl;
+                return -4;
+            }
+            continue;
+        }
+
+        //
+        // Validate all the buffers against the ones without flag
+        //
+        size_t Mismatches = 0;
+        double MaxError = 0.0;
+        for (size_t i = 0; i < Pipeline.Buffers.size() && Combination != 0; i++) {
+            const BufferDef & Buffer = Pipeline.Buffers[i];
+            double BufferError;
+
+            Mismatches += FindType(Buffer.Type)->Compare(&Reference[i][0], &Contents[i][0], Buffer.Size,
+                                                         Options.Tolerance, BufferError);
+            MaxError = std::max(MaxError, BufferError);
+        }
+
+        std::sort(Times.Span.begin(), Times.Span.end());
+        double Time = GetMedian(Times.Span);
+        if (Combination == 0) {
+            ReferenceTime = Time;
+        }
+
+        std::cout << std::setw(14) << Time / 1000.0 << std::setw(10) << (Time == 0.0 ? 0.0 : ReferenceTime / Time)
+                  << std::setw(14) << std::scientific << std::setprecision(2) << MaxError << std::fixed
+                  << std::setprecision(3) << "  " << (Flags.empty() ? "(none)" : Flags)
+                  << (Mismatches == 0 ? "" : " (out of tolerance)") << std::endl;
+
+        if (Mismatches == 0 && (Combination == 0 || Time < BestTime)) {
+            Best = Combination;
+            BestTime = Time;
+        }
+    }
+
+    std::string Flags;
+    for (size_t i = 0; i < Options.Flags.size(); i++) {
+        if (Best & (static_cast<size_t>(1) << i)) {
+            Flags += (Flags.empty() ? "" : " ") + Options.Flags[i];
+        }
+    }
+
+    std::cout << "Fastest:    " << (Flags.empty() ? "(none)" : Flags) << ", " << BestTime / 1000.0 << " us ("
+              << (BestTime == 0.0 ? 0.0 : ReferenceTime / BestTime) << "x)" << std::endl;
+
+    return 0;
+}
+
+///
+/// \struct SweepResult
+/// \brief  Result of a single combination of the swept parameters
+///
+struct SweepResult {
+    /// Name of the device the pipeline ran on, empty if none was found
+    std::string   Device;
+    /// Error of the run, CL_SUCCESS if none
+    cl_int        Error;
+    /// Bytes of the buffers passed to all the kernels
+    double        Bytes;
+    /// Times of the measured runs
+    PipelineTimes Times;
+};
+
+///
+/// \fn     RunSweep
+/// \param  Points    All the combinations of the swept parameters
+/// \param  Pipelines The pipeline of each combination
+/// \param  Device    The device the combinations run on
+/// \param  Indices   The combinations to run
+/// \param  Results   The result of each combination
+/// \brief  This function runs combinations on a device, one after another
+/// \details A single OpenCL instance is used, so that the context and the
+///          programs built with the same defines are reused. Buffers are
+///          released after each combination.
+///
+static void RunSweep(const std::vector<SweepPoint> & Points, std::vector<PipelineDef> & Pipelines,
+                     const cl::Device & Device, const std::vector<size_t> & Indices,
+                     std::vector<SweepResult> & Results) {
+    OpenCLWrapper::OpenCL OclObject;
+
+    //
+    // Times are read from the events, so profile every command
+    //
+    cl_int Error = OclObject.SetUsedDevice(Device);
+    if (Error == CL_SUCCESS) {
+        Error = OclObject.SetParameter(OpenCLWrapper::ProfilingMode, OpenCLWrapper::ProfilingAlways);
+    }
+
+    for (size_t i = 0; i < Indices.size(); i++) {
+        PipelineDef & Pipeline = Pipelines[Indices[i]];
+        SweepResult & Result = Results[Indices[i]];
+
+        Result.Error = Error;
+        Result.Bytes = 0.0;
+        if (Error != CL_SUCCESS) {
+            continue;
+        }
+
+        Result.Device = Device.getInfo<CL_DEVICE_NAME>();
+        for (size_t j = 0; j < Pipeline.Kernels.size(); j++) {
+            Result.Bytes += GetKernelBytes(Pipeline, Pipeline.Kernels[j]);
+        }
+
+        std::string Options;
+        const SweepPoint & Point = Points[Indices[i]];
+        for (size_t j = 0; j < Point.Defines.size(); j++) {
+            Options += (j == 0 ? "-D " : " -D ") + Point.Defines[j].first + "=" + Point.Defines[j].second;
+        }
+        OclObject.SetParameter(OpenCLWrapper::BuildOptions, Options);
+
+        Result.Error = PreparePipeline(OclObject, Pipeline);
+        if (Result.Error == CL_SUCCESS) {
+            Result.Error = RunPipeline(OclObject, Pipeline, Result.Times);
+        }
+
+        for (size_t j = 0; j < Pipeline.Buffers.size(); j++) {
+            Pipeline.Buffers[j].Buffer = cl::Buffer();
+        }
+        for (size_t j = 0; j < Pipeline.Kernels.size(); j++) {
+            Pipeline.Kernels[j].Kernel = cl::Kernel();
+        }
+    }
+}
+
+///
+/// \fn     GetSummary
+/// \param  Samples Times, in ns
+/// \param  Summary min, median and max of the samples
+///
+static void GetSummary(std::vector<double> Samples, double Summary[3]) {
+    std::sort(Samples.begin(), Samples.end());
+    Summary[0] = (Samples.empty() ? 0.0 : Samples.front());
+    Summary[1] = GetMedian(Samples);
+    Summary[2] = (Samples.empty() ? 0.0 : Samples.back());
+}
+
+///
+/// \fn     QuoteCsv
+/// \param  Text The field
+/// \return The field quoted, with its quotes doubled
+///
+static std::string QuoteCsv(const std::string & Text) {
+    std::string Quoted("\"");
+
+    for (size_t i = 0; i < Text.size(); i++) {
+        Quoted += (Text[i] == '"' ? "\"\"" : std::string(1, Text[i]));
+    }
+
+    return Quoted + "\"";
+}
+
+///
+/// \fn     WriteSweep
+/// \param  Stream  Stream to write to
+/// \param  Points  All the combinations of the swept parameters
+/// \param  Results The result of each combination
+/// \param  Json    Whether the table is written as JSON, CSV otherwise
+/// \brief  This function outputs one row per combination
+/// \details Times are in us and the bandwidth in GB/s, at the median
+///          device time. Rows that failed have their OpenCL error set and
+///          no time.
+///
+static void WriteSweep(std::ostream & Stream, const std::vector<SweepPoint> & Points,
+                       const std::vector<SweepResult> & Results, bool Json) {
+    if (Json) {
+        Stream << "[" << std::endl;
+    } else {
+        Stream << "target,device,size,local";
+        for (size_t i = 0; i < Points[0].Defines.size(); i++) {
+            Stream << "," << QuoteCsv(Points[0].Defines[i].first);
+        }
+        Stream << ",error,device_min_us,device_median_us,device_max_us,host_median_us,bandwidth_gbs" << std::endl;
+    }
+
+    for (size_t i = 0; i < Points.size(); i++) {
+        const SweepPoint & Point = Points[i];
+        const SweepResult & Result = Results[i];
+        double Device[3], Host[3];
+
+        GetSummary(Result.Times.Span, Device);
+        GetSummary(Result.Times.Host, Host);
+        double Bandwidth = (Device[1] == 0.0 ? 0.0 : Result.Bytes / Device[1]);
+
+        if (Json) {
+            Stream << "  {\"target\": \"" << OpenCLWrapper::EscapeJson(Point.TargetName)
+                   << "\", \"device\": \"" << OpenCLWrapper::EscapeJson(Result.Device)
+                   << "\", \"size\": \"" << OpenCLWrapper::EscapeJson(Point.Size)
+                   << "\", \"local\": \"" << OpenCLWrapper::EscapeJson(Point.Local) << "\", \"defines\": {";
+            for (size_t j = 0; j < Point.Defines.size(); j++) {
+                Stream << (j == 0 ? "" : ", ") << "\"" << OpenCLWrapper::EscapeJson(Point.Defines[j].first)
+                       << "\": \"" << OpenCLWrapper::EscapeJson(Point.Defines[j].second) << "\"";
+            }
+            Stream << "}, \"error\": " << Result.Error << ", \"device_us\": {\"min\": " << Device[0] / 1000.0
+                   << ", \"median\": " << Device[1] / 1000.0 << ", \"max\": " << Device[2] / 1000.0
+                   << "}, \"host_median_us\": " << Host[1] / 1000.0 << ", \"bandwidth_gbs\": " << Bandwidth
+                   << "}" << (i + 1 == Points.size() ? "" : ",") << std::endl;
+        } else {
+            Stream << QuoteCsv(Point.TargetName) << "," << QuoteCsv(Result.Device) << ","
+                   << QuoteCsv(Point.Size) << "," << QuoteCsv(Point.Local);
+            for (size_t j = 0; j < Point.Defines.size(); j++) {
+                Stream << "," << QuoteCsv(Point.Defines[j].second);
+            }
+            Stream << "," << Result.Error << "," << Device[0] / 1000.0 << "," << Device[1] / 1000.0
+                   << "," << Device[2] / 1000.0 << "," << Host[1] / 1000.0 << "," << Bandwidth << std::endl;
+        }
+    }
+
+    if (Json) {
+        Stream << "]" << std::endl;
+    }
+}
+
+///
+/// \fn     Sweep
+/// \param  XmlContext The XPath context of the config file
+/// \param  Points     All the combinations of the swept parameters
+/// \param  Options    How the results are output
+/// \return 0 in case of success, -error otherwise
+/// \brief  This function runs all the combinations and outputs the table
+/// \details Combinations are grouped by the device their target selects,
+///          so that targets selecting the same device share a group. Each
+///          group of a GPU or an accelerator runs on its own thread, so
+///          that different devices run in parallel. Groups of a CPU run
+///          alone afterwards, as they would compete with the host threads
+///          and skew the host times. The fastest combination of each
+///          device is reported on stderr.
+///
+static int Sweep(xmlXPathContextPtr XmlContext, const std::vector<SweepPoint> & Points,
+                 const SweepOptions & Options) {
+    std::vector<PipelineDef> Pipelines(Points.size());
+    std::vector<SweepResult> Results(Points.size());
+    std::vector<std::vector<size_t> > Groups;
+    std::vector<cl::Device> Devices;
+    std::vector<cl_device_id> Ids;
+    std::vector<cl_device_type> Targets;
+    std::vector<cl_int> TargetErrors;
+    std::vector<cl::Device> TargetDevices;
+
+    //
+    // Parse all the combinations first, libxml2 isn't used by the threads
+    //
+    for (size_t i = 0; i < Points.size(); i++) {
+        if (!ParsePipeline(XmlContext, Points[i], Pipelines[i])) {
+            return -3;
+        }
+
+        //
+        // Select the device of each target once, before any thread starts
+        //
+        size_t Target = std::find(Targets.begin(), Targets.end(), Pipelines[i].Target) - Targets.begin();
+        if (Target == Targets.size()) {
+            OpenCLWrapper::OpenCL OclObject;
+            cl::Device Device;
+
+            OclObject.SetParameter(OpenCLWrapper::TargetDevice, Pipelines[i].Target);
+            Targets.push_back(Pipelines[i].Target);
+            TargetErrors.push_back(OclObject.GetUsedDevice(Device));
+            TargetDevices.push_back(Device);
+        }
+
+        if (TargetErrors[Target] != CL_SUCCESS) {
+            Results[i].Error = TargetErrors[Target];
+            Results[i].Bytes = 0.0;
+            continue;
+        }
+
+        size_t Group = std::find(Ids.begin(), Ids.end(), TargetDevices[Target]()) - Ids.begin();
+        if (Group == Ids.size()) {
+            Ids.push_back(TargetDevices[Target]());
+            Devices.push_back(TargetDevices[Target]);
+            Groups.push_back(std::vector<size_t>());
+        }
+        Groups[Group].push_back(i);
+    }
+
+    std::vector<std::thread> Threads;
+    for (size_t i = 0; i < Groups.size(); i++) {
+        if (Devices[i].getInfo<CL_DEVICE_TYPE>() & CL_DEVICE_TYPE_CPU) {
+            continue;
+        }
+
+        try {
+            Threads.push_back(std::thread(RunSweep, std::cref(Points), std::ref(Pipelines),
+                                          std::cref(Devices[i]), std::cref(Groups[i]), std::ref(Results)));
+        } catch (const std::system_error &) {
+            RunSweep(Points, Pipelines, Devices[i], Groups[i], Results);
+        }
+    }
+
+    for (size_t i = 0; i < Threads.size(); i++) {
+        Threads[i].join();
+    }
+
+    for (size_t i = 0; i < Groups.size(); i++) {
+        if (Devices[i].getInfo<CL_DEVICE_TYPE>() & CL_DEVICE_TYPE_CPU) {
+            RunSweep(Points, Pipelines, Devices[i], Groups[i], Results);
+        }
+    }
+
+    //
+    // Report the fastest combination of each target
+    //
+    for (size_t i = 0; i < Groups.size(); i++) {
+        size_t Best = Points.size();
+        double BestTime = 0.0;
+
+        for (size_t j = 0; j < Groups[i].size(); j++) {
+            const SweepResult & Result = Results[Groups[i][j]];
+            double Device[3];
+
+            GetSummary(Result.Times.Span, Device);
+            if (Result.Error == CL_SUCCESS && (Best == Points.size() || Device[1] < BestTime)) {
+                Best = Groups[i][j];
+                BestTime = Device[1];
+            }
+        }
+
+        if (Best != Points.size()) {
+            const SweepPoint & Point = Points[Best];
+            std::cerr << "Fastest on " << Results[Best].Device << ": " << BestTime / 1000.0 << " us with size="
+                      << Point.Size << " local=" << Point.Local;
+            for (size_t j = 0; j < Point.Defines.size(); j++) {
+                std::cerr << " " << Point.Defines[j].first << "=" << Point.Defines[j].second;
+            }
+            std::cerr << std::endl;
+        }
+    }
+
+    if (Options.Output.empty()) {
+        WriteSweep(std::cout, Points, Results, Options.Json);
+    } else {
+        std::ofstream Output(Options.Output.c_str());
+        if (!Output.is_open()) {
+            std::cerr << "Could not open: " << Options.Output << std::endl;
+            return -5;
+        }
+
+        WriteSweep(Output, Points, Results, Options.Json);
+    }
+
     return 0;
 }
 
@@ -31,16 +1939,23 @@ static int PrintUsage(const char * ProgName) {
 /// \param  argv All the passed arguments
 /// \return 0 in case of success, -error otherwise
 /// \brief  Main function
+/// \details The config file declares the kernels, the buffers they share,
+///          their arguments and dependencies, their ranges and how many
+///          times they are run. The kernels are then run and their times
+///          are reported. If the config file declares a sweep, all the
+///          combinations are run and a table of their times is output.
+///          If it declares a tune, the kernels are built with all the
+///          combinations of flags and the fastest valid one is reported.
 ///
 int main(int argc, char ** argv) {
-    struct stat stbuf;
     xmlDocPtr XmlFile = 0;
-    xmlNodePtr OldNode = 0;
     const char * ConfigFile;
     OpenCLWrapper::OpenCL OclObject;
-    xmlXPathObjectPtr XmlObject = 0;
     xmlXPathContextPtr XmlContext = 0;
-    KernelDef Kernel = {"", "", CL_DEVICE_TYPE_ALL};
+    PipelineDef Pipeline;
+    std::vector<SweepPoint> Points;
+    SweepOptions Options;
+    TuneOptions Tuning;
 
     //
     // Check for the config file
@@ -66,86 +1981,82 @@ int main(int argc, char ** argv) {
         return -2;
     }
 
-    //
-    // First get the file name that contains the kernel to execute
-    //
-    XmlObject = xmlXPathEval(BAD_CAST"string(/kernel/@file)", XmlContext);
-    if ((XmlObject != 0) && ((XmlObject->type == XPATH_STRING) &&
-        (XmlObject->stringval != NULL) && (XmlObject->stringval[0] != 0))) {
-        Kernel.File = reinterpret_cast<const char*>(XmlObject->stringval);
-    }
-
-    if (XmlObject) {
-        xmlXPathFreeObject(XmlObject);
-        XmlObject = 0;
-    }
+    if (!ParseSweep(XmlContext, Points, Options) || !ParseTune(XmlContext, Tuning) ||
+        (Options.Enabled && Tuning.Enabled)) {
+        if (Options.Enabled && Tuning.Enabled) {
+            std::cout << "A config file cannot both sweep and tune" << std::endl;
+        }
 
-    //
-    // Ensure that file name is correct and that the file exists
-    //
-    if (Kernel.File == "") {
-        std::cout << "Kernel file name was not provided" << std::endl;
         xmlXPathFreeContext(XmlContext);
         xmlFreeDoc(XmlFile);
         return -3;
     }
 
+    if (Options.Enabled) {
+        int Status = Sweep(XmlContext, Points, Options);
 
-    if (stat(Kernel.File.c_str(), &stbuf) != 0) {
-        std::cout << "Kernel file was incorrect" << std::endl;
         xmlXPathFreeContext(XmlContext);
         xmlFreeDoc(XmlFile);
+
+        return Status;
+    }
+
+    bool Parsed = ParsePipeline(XmlContext, Points[0], Pipeline);
+
+    xmlXPathFreeContext(XmlContext);
+    xmlFreeDoc(XmlFile);
+
+    if (!Parsed) {
         return -3;
     }
 
     //
-    // Get the kernel name
+    // Immediately set target to ensure it is well used
     //
-    XmlObject = xmlXPathEval(BAD_CAST"string(/kernel/@name)", XmlContext);
-    if ((XmlObject != 0) && ((XmlObject->type == XPATH_STRING) &&
-        (XmlObject->stringval != NULL) && (XmlObject->stringval[0] != 0))) {
-        Kernel.Name = reinterpret_cast<const char*>(XmlObject->stringval);
-    }
-
-    if (XmlObject) {
-        xmlXPathFreeObject(XmlObject);
-        XmlObject = 0;
-    }
+    OclObject.SetParameter(OpenCLWrapper::TargetDevice, Pipeline.Target);
 
     //
-    // Ensure that kernel name is not empty
+    // Times are read from the events, so profile every command
     //
-    if (Kernel.Name == "") {
-        std::cout << "Kernel name was not provided" << std::endl;
-        xmlXPathFreeContext(XmlContext);
-        xmlFreeDoc(XmlFile);
-        return -3;
+    cl_int Error = OclObject.SetParameter(OpenCLWrapper::ProfilingMode, OpenCLWrapper::ProfilingAlways);
+    if (Error != CL_SUCCESS) {
+        std::cerr << "Failed to enable profiling: " << Error << std::endl;
+        return -4;
     }
 
     //
-    // Get target if any
+    // Build the kernels and run them
     //
-    XmlObject = xmlXPathEval(BAD_CAST"string(/kernel/target/@type)", XmlContext);
-    if ((XmlObject != 0) && ((XmlObject->type == XPATH_STRING) &&
-        (XmlObject->stringval != NULL) && (XmlObject->stringval[0] != 0))) {
-        std::string Type = reinterpret_cast<const char*>(XmlObject->stringval);
-        if (Type.compare("cpu") == 0) {
-            Kernel.Target = CL_DEVICE_TYPE_CPU;
-        } else if (Type.compare("gpu") == 0) {
-            Kernel.Target = CL_DEVICE_TYPE_GPU;
-        } else if (Type.compare("accelerator") == 0) {
-            Kernel.Target = CL_DEVICE_TYPE_ACCELERATOR;
+    cl::Device Device;
+    PipelineTimes Times;
+
+    Error = OclObject.GetUsedDevice(Device);
+    if (Error != CL_SUCCESS) {
+        std::cerr << "No OpenCL device found: " << Error << std::endl;
+        return -4;
+    }
+
+    if (Tuning.Enabled) {
+        return Tune(OclObject, Pipeline, Tuning);
+    }
+
+    Error = PreparePipeline(OclObject, Pipeline);
+    if (Error == CL_SUCCESS) {
+        Error = RunPipeline(OclObject, Pipeline, Times);
+    }
+
+    for (size_t i = 0; i < Pipeline.Buffers.size() && Error == CL_SUCCESS; i++) {
+        if (!Pipeline.Buffers[i].Output.empty()) {
+            Error = StoreBuffer(OclObject, Pipeline.Buffers[i]);
         }
     }
 
-    //
-    // Immediately set target to ensure it is well used
-    //
-    OclObject.SetParameter(OpenCLWrapper::TargetDevice, Kernel.Target);
+    if (Error != CL_SUCCESS) {
+        std::cerr << "Could not run the kernels: " << Error << std::endl;
+        return -4;
+    }
+
+    WriteReport(Device.getInfo<CL_DEVICE_NAME>(), Pipeline, Times);
 
-    //
-    // Unimplemented
-    //
-    assert(false);
     return 0;
 }